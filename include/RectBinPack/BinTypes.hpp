@@ -0,0 +1,257 @@
+/**
+ * \file BinTypes.hpp
+ * Packing into bins of different sizes chosen from a catalog
+ */
+
+#pragma once
+
+#include "RectBinPack.hpp"
+#include "Guillotine.hpp"
+#include "MaxRects.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace RectBinPack {
+	/**
+	 * \addtogroup BinTypes
+	 * @{
+	 */
+
+	/// Type of bin which can be opened while packing
+	struct BinType {
+		unsigned int width; ///< Width of the bin
+		unsigned int height; ///< Height of the bin
+		double cost; ///< Cost of opening a bin of this type
+		int maxCount; ///< Maximum number of bins of this type. Unlimited if less than 1
+	};
+
+	/// Contains the result of packing with bin types
+	struct BinTypeResult {
+		/**
+		 * \brief Indicates if the algorithm failed to pack all rectangles into the available bins
+		 *
+		 * Unpacked rectangles are set to InvalidBin.
+		 */
+		bool failed;
+
+		unsigned int numBins; ///< Number of bins used for packing
+		std::vector<std::size_t> binTypes; ///< Index of the type of every bin
+		double cost; ///< Total cost of all bins
+	};
+
+	/// \cond INTERNAL
+	namespace Internal {
+		/// Implementation of packing with bin types
+		template<typename Configuration, typename It>
+		class BinTypePacking {
+		public:
+			/**
+			 * \brief Constructs the class and copies the sizes of the rectangles
+			 *
+			 * \param config Configuration of the algorithm. Its size and number of bins are replaced.
+			 * \param types Catalog of bin types
+			 * \param begin Begin iterator of the sequence
+			 * \param end End iterator of the sequence
+			 * \param size Size of the sequence. Helps the internal vector reserve enough space, can be set to 0
+			 */
+			template<typename ItEnd>
+			BinTypePacking(const Configuration& config, const std::vector<BinType>& types, It begin, ItEnd end, std::size_t size):
+				m_config(config), m_types(types), m_counts(types.size(), 0) {
+
+				// Every attempt packs into a single bin. Stopping early would leave it empty as soon as the rest doesn't
+				// fit, instead of filling it with what does.
+				m_config.minBins = 1;
+				m_config.maxBins = 1;
+				m_config.stopEarly = false;
+
+				m_rects.reserve(size);
+				m_sizes.reserve(size);
+
+				for (auto it = begin; it != end; ++it) {
+					const auto rect = toRect(*it);
+
+					if (rect.width > 0 && rect.height > 0) {
+						m_rects.push_back(it);
+						m_sizes.push_back({ 0, 0, rect.width, rect.height });
+					}
+					else
+						fromBinRect(*it, { { 0, 0, 0, 0 }, InvalidBin, false });
+				}
+			}
+
+			/**
+			 * \brief Opens bins until all rectangles are packed
+			 *
+			 * Every step packs the rectangles left into a single bin of every type which is still available. If a
+			 * type can take all of them, the cheapest of those types closes out the packing. Otherwise the type with
+			 * the lowest cost per packed area is opened.
+			 */
+			BinTypeResult pack() {
+				BinTypeResult result { false, 0, {}, 0 };
+				std::vector<std::size_t> pending(m_rects.size());
+
+				for (std::size_t i = 0; i < pending.size(); ++i)
+					pending[i] = i;
+
+				while (!pending.empty()) {
+					std::vector<BinRect> best;
+					auto bestType = m_types.size();
+					auto bestFinishes = false;
+					auto bestScore = std::numeric_limits<double>::max();
+
+					for (std::size_t type = 0; type < m_types.size(); ++type) {
+						if (m_types[type].maxCount > 0 && m_counts[type] >= (unsigned int) m_types[type].maxCount)
+							continue;
+
+						auto attempt = tryType(type, pending);
+						std::uint64_t packedArea = 0;
+						auto finishes = true;
+
+						for (auto& rect : attempt) {
+							if (rect.bin == InvalidBin)
+								finishes = false;
+							else
+								packedArea += (std::uint64_t) rect.rect.width * rect.rect.height;
+						}
+
+						if (packedArea == 0)
+							continue;
+
+						const auto score = finishes ? m_types[type].cost : m_types[type].cost / packedArea;
+
+						if ((finishes && !bestFinishes) || (finishes == bestFinishes && score < bestScore)) {
+							best = std::move(attempt);
+							bestType = type;
+							bestFinishes = finishes;
+							bestScore = score;
+						}
+					}
+
+					// No type is left which can take any of the rectangles
+					if (bestType == m_types.size()) {
+						for (auto i : pending)
+							fromBinRect(*m_rects[i], { m_sizes[i], InvalidBin, false });
+
+						result.failed = true;
+						break;
+					}
+
+					std::vector<std::size_t> left;
+
+					for (std::size_t i = 0; i < pending.size(); ++i) {
+						if (best[i].bin == InvalidBin)
+							left.push_back(pending[i]);
+						else
+							fromBinRect(*m_rects[pending[i]], { best[i].rect, result.numBins, best[i].flipped });
+					}
+
+					++m_counts[bestType];
+					++result.numBins;
+					result.binTypes.push_back(bestType);
+					result.cost += m_types[bestType].cost;
+					pending = std::move(left);
+				}
+
+				return result;
+			}
+
+		private:
+			/// Packs the rectangles into a single bin of the type. Rectangles which don't fit are set to InvalidBin.
+			std::vector<BinRect> tryType(std::size_t type, const std::vector<std::size_t>& pending) {
+				m_config.width = m_types[type].width;
+				m_config.height = m_types[type].height;
+
+				std::vector<Rect> sizes;
+				sizes.reserve(pending.size());
+
+				for (auto i : pending)
+					sizes.push_back(m_sizes[i]);
+
+				// Rectangles which are too large for the type or blocked by the obstacles are left out, so the others
+				// can still be packed
+				const auto fits = Internal::fitsEmptyBin(m_config, sizes);
+
+				std::vector<BinRect> attempt;
+				std::vector<BinRect> fitting;
+				std::vector<std::size_t> indices;
+
+				attempt.reserve(pending.size());
+
+				for (std::size_t i = 0; i < pending.size(); ++i) {
+					attempt.push_back({ sizes[i], InvalidBin, false });
+
+					if (fits[i]) {
+						fitting.push_back({ sizes[i], InvalidBin, false });
+						indices.push_back(i);
+					}
+				}
+
+				Internal::pack(m_config, fitting.begin(), fitting.end(), fitting.size());
+
+				for (std::size_t i = 0; i < fitting.size(); ++i)
+					if (fitting[i].bin == 0)
+						attempt[indices[i]] = fitting[i];
+
+				return attempt;
+			}
+
+			Configuration m_config;
+			const std::vector<BinType>& m_types;
+			std::vector<unsigned int> m_counts;
+			std::vector<It> m_rects;
+			std::vector<Rect> m_sizes;
+		};
+	}
+	/// \endcond
+
+	/**
+	 * \brief Packs rectangles into bins chosen from a catalog of bin types
+	 *
+	 * Bins are opened one after another. Every time the rectangles left are packed into a single bin of every type
+	 * which is still available. If some types can take all of them, the cheapest one is opened, so remnants end up in
+	 * small bins. Otherwise the type with the lowest cost per packed area is opened. The packing function is chosen by
+	 * the configuration type (e.g. MaxRectsConfiguration, GuillotineConfiguration).
+	 *
+	 * The width, height and the number of bins of \p config are ignored. The index of empty rectangles is always set
+	 * to InvalidBin.
+	 *
+	 * \param config Configuration of the algorithm
+	 * \param types Catalog of bin types
+	 * \param begin Begin iterator of the sequence of rectangles
+	 * \param end End iterator of the sequence of rectangles
+	 * \param size Size of the sequence. Helps the internal vector reserve enough space, can be set to 0
+	 * \returns If the packing suceeded, the number of used bins, their types and the total cost
+	 */
+	template<typename Configuration, typename It, typename ItEnd>
+	BinTypeResult packBinTypes(const Configuration& config, const std::vector<BinType>& types, It begin, ItEnd end, std::size_t size = 0) {
+		Internal::BinTypePacking<Configuration, It> packing(config, types, begin, end, size);
+		return packing.pack();
+	}
+
+	/**
+	 * \brief Packs rectangles into bins chosen from a catalog of bin types
+	 *
+	 * Bins are opened one after another. Every time the rectangles left are packed into a single bin of every type
+	 * which is still available. If some types can take all of them, the cheapest one is opened, so remnants end up in
+	 * small bins. Otherwise the type with the lowest cost per packed area is opened. The packing function is chosen by
+	 * the configuration type (e.g. MaxRectsConfiguration, GuillotineConfiguration).
+	 *
+	 * The width, height and the number of bins of \p config are ignored. The index of empty rectangles is always set
+	 * to InvalidBin.
+	 *
+	 * \param config Configuration of the algorithm
+	 * \param types Catalog of bin types
+	 * \param collection Collection of rectangles e.g. vector, list, array
+	 * \returns If the packing suceeded, the number of used bins, their types and the total cost
+	 */
+	template<typename Configuration, typename Collection>
+	BinTypeResult packBinTypes(const Configuration& config, const std::vector<BinType>& types, Collection& collection) {
+		return packBinTypes(config, types, std::begin(collection), std::end(collection), Internal::size(collection));
+	}
+
+	/**
+	 * @}
+	 */
+}
@@ -0,0 +1,358 @@
+/**
+ * \file BinaryFormat.hpp
+ * Binary file format for large sets of rectangles which can be memory-mapped and packed in place
+ */
+
+#pragma once
+
+#include "RectBinPack.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#ifdef _WIN32
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace RectBinPack {
+	/**
+	 * \addtogroup BinaryFormat
+	 * @{
+	 */
+
+	/// Exception thrown if a binary rectangle file can't be opened, mapped or has an invalid header
+	class BinaryFormatError: public std::runtime_error {
+	public:
+		/// Construct from message string
+		explicit BinaryFormatError(const char* msg):
+			std::runtime_error(msg) { }
+
+		/// Construct from message string
+		explicit BinaryFormatError(const std::string& msg):
+			std::runtime_error(msg) { }
+	};
+
+	/**
+	 * \brief Header at the start of a binary rectangle file
+	 *
+	 * The header is followed by #count records of type BinaryRecord. All values are stored in the byte order of the
+	 * machine which wrote the file, which is detected with #byteOrder.
+	 */
+	struct BinaryHeader {
+		char magic[4]; ///< Always "RBPK"
+		std::uint32_t byteOrder; ///< Always 0x01020304 in the byte order of the file
+		std::uint32_t version; ///< Version of the format, currently 1
+		std::uint32_t recordSize; ///< Size of a single record in bytes
+		std::uint64_t count; ///< Number of records following the header
+	};
+
+	/// Record of a single rectangle. The size is read before packing, the placement is written back after it.
+	struct BinaryRecord {
+		std::uint32_t x; ///< X position of the packed rectangle
+		std::uint32_t y; ///< Y position of the packed rectangle
+		std::uint32_t width; ///< Width of the rectangle. Swapped with the height if it was flipped.
+		std::uint32_t height; ///< Height of the rectangle. Swapped with the width if it was flipped.
+		std::uint32_t bin; ///< Number of the bin starting with 0. It can be InvalidBin.
+		std::uint32_t flags; ///< Bit 0 is set if the rectangle was flipped
+	};
+
+	/// Flag of BinaryRecord::flags which indicates that the rectangle was flipped
+	const std::uint32_t BinaryFlipped = 1;
+
+	/// Current version of the binary format
+	const std::uint32_t BinaryVersion = 1;
+
+	/// Conversion function from BinaryRecord to Rect
+	inline Rect toRect(const BinaryRecord& value) {
+		return { value.x, value.y, value.width, value.height };
+	}
+
+	/// Conversion function from BinRect to BinaryRecord
+	inline void fromBinRect(BinaryRecord& dst, BinRect rect) {
+		dst.x = rect.rect.x;
+		dst.y = rect.rect.y;
+		dst.width = rect.rect.width;
+		dst.height = rect.rect.height;
+		dst.bin = rect.bin;
+		dst.flags = rect.flipped ? BinaryFlipped : 0;
+	}
+
+	/**
+	 * \brief View of the records in a binary rectangle file
+	 *
+	 * The view doesn't own or copy the memory. It can be passed directly to the packing functions, which write the
+	 * placements back into the records.
+	 */
+	class BinaryView {
+	public:
+		/// Constructs an empty view
+		BinaryView() = default;
+
+		/**
+		 * \brief Constructs the view from the contents of a binary rectangle file
+		 *
+		 * \param data Pointer to the start of the file. It must be aligned to 8 bytes.
+		 * \param size Size of the file in bytes
+		 * \throws BinaryFormatError if the header is invalid or the file is too small
+		 */
+		BinaryView(void* data, std::size_t size) {
+			if (size < sizeof(BinaryHeader))
+				throw BinaryFormatError("file is too small for the header");
+
+			const auto header = static_cast<const BinaryHeader*>(data);
+
+			if (std::memcmp(header->magic, "RBPK", 4) != 0)
+				throw BinaryFormatError("invalid magic number");
+
+			if (header->byteOrder != 0x01020304)
+				throw BinaryFormatError("file has a different byte order");
+
+			if (header->version != BinaryVersion || header->recordSize != sizeof(BinaryRecord))
+				throw BinaryFormatError("unsupported version");
+
+			if (header->count > (size - sizeof(BinaryHeader)) / sizeof(BinaryRecord))
+				throw BinaryFormatError("file is too small for the records");
+
+			m_begin = reinterpret_cast<BinaryRecord*>(static_cast<char*>(data) + sizeof(BinaryHeader));
+			m_size = (std::size_t) header->count;
+		}
+
+		/// Returns the first record
+		BinaryRecord* begin() const {
+			return m_begin;
+		}
+
+		/// Returns the end of the records
+		BinaryRecord* end() const {
+			return m_begin + m_size;
+		}
+
+		/// Returns the number of records
+		std::size_t size() const {
+			return m_size;
+		}
+
+		/// Returns the record at \p index
+		BinaryRecord& operator[](std::size_t index) const {
+			return m_begin[index];
+		}
+
+	private:
+		BinaryRecord* m_begin = nullptr;
+		std::size_t m_size = 0;
+	};
+
+	/**
+	 * \brief Memory-mapped binary rectangle file
+	 *
+	 * Maps the whole file for reading and writing. Changes to the records are written to the file when it's unmapped.
+	 */
+	class MappedBinaryFile {
+	public:
+		/**
+		 * \brief Opens and maps the file
+		 *
+		 * \param path Path of the file
+		 * \throws BinaryFormatError if the file can't be opened or mapped or has an invalid header
+		 */
+		explicit MappedBinaryFile(const std::string& path) {
+#ifdef _WIN32
+			m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL, nullptr);
+
+			if (m_file == INVALID_HANDLE_VALUE)
+				throw BinaryFormatError("cannot open " + path);
+
+			LARGE_INTEGER size;
+
+			if (!GetFileSizeEx(m_file, &size)) {
+				close();
+				throw BinaryFormatError("cannot get size of " + path);
+			}
+
+			m_size = (std::size_t) size.QuadPart;
+			m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+
+			if (m_mapping)
+				m_data = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+
+			if (!m_data) {
+				close();
+				throw BinaryFormatError("cannot map " + path);
+			}
+#else
+			m_file = ::open(path.c_str(), O_RDWR);
+
+			if (m_file < 0)
+				throw BinaryFormatError("cannot open " + path);
+
+			struct stat status;
+
+			if (fstat(m_file, &status) != 0) {
+				close();
+				throw BinaryFormatError("cannot get size of " + path);
+			}
+
+			m_size = (std::size_t) status.st_size;
+
+			if (m_size > 0) {
+				m_data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+
+				if (m_data == MAP_FAILED) {
+					m_data = nullptr;
+					close();
+					throw BinaryFormatError("cannot map " + path);
+				}
+			}
+#endif
+
+			try {
+				m_view = BinaryView(m_data, m_size);
+			}
+			catch (...) {
+				close();
+				throw;
+			}
+		}
+
+		MappedBinaryFile(const MappedBinaryFile&) = delete;
+		MappedBinaryFile& operator=(const MappedBinaryFile&) = delete;
+
+		/// Unmaps and closes the file
+		~MappedBinaryFile() {
+			close();
+		}
+
+		/// Returns the first record
+		BinaryRecord* begin() const {
+			return m_view.begin();
+		}
+
+		/// Returns the end of the records
+		BinaryRecord* end() const {
+			return m_view.end();
+		}
+
+		/// Returns the number of records
+		std::size_t size() const {
+			return m_view.size();
+		}
+
+		/// Returns the record at \p index
+		BinaryRecord& operator[](std::size_t index) const {
+			return m_view[index];
+		}
+
+		/// Returns the view of the records
+		const BinaryView& view() const {
+			return m_view;
+		}
+
+	private:
+		void close() {
+#ifdef _WIN32
+			if (m_data)
+				UnmapViewOfFile(m_data);
+
+			if (m_mapping)
+				CloseHandle(m_mapping);
+
+			if (m_file != INVALID_HANDLE_VALUE)
+				CloseHandle(m_file);
+
+			m_mapping = nullptr;
+			m_file = INVALID_HANDLE_VALUE;
+#else
+			if (m_data)
+				munmap(m_data, m_size);
+
+			if (m_file >= 0)
+				::close(m_file);
+
+			m_file = -1;
+#endif
+
+			m_data = nullptr;
+		}
+
+#ifdef _WIN32
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = nullptr;
+#else
+		int m_file = -1;
+#endif
+		void* m_data = nullptr;
+		std::size_t m_size = 0;
+		BinaryView m_view;
+	};
+
+	/**
+	 * \brief Writes rectangles into a binary rectangle file
+	 *
+	 * The rectangles are converted with toRect and streamed into the file one by one. Positions are written as they
+	 * are, the bins are set to InvalidBin.
+	 *
+	 * \param path Path of the file. It's overwritten if it exists.
+	 * \param begin Begin iterator of the sequence of rectangles
+	 * \param end End iterator of the sequence of rectangles
+	 * \throws BinaryFormatError if the file can't be written
+	 */
+	template<typename It, typename ItEnd>
+	void writeBinaryFile(const std::string& path, It begin, ItEnd end) {
+		std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+
+		if (!stream)
+			throw BinaryFormatError("cannot open " + path);
+
+		BinaryHeader header { { 'R', 'B', 'P', 'K' }, 0x01020304, BinaryVersion, sizeof(BinaryRecord), 0 };
+
+		// The count is patched after all records are written
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		for (auto it = begin; it != end; ++it) {
+			const auto rect = toRect(*it);
+			const BinaryRecord record { rect.x, rect.y, rect.width, rect.height, InvalidBin, 0 };
+
+			stream.write(reinterpret_cast<const char*>(&record), sizeof(record));
+			++header.count;
+		}
+
+		stream.seekp(0);
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		if (!stream)
+			throw BinaryFormatError("cannot write " + path);
+	}
+
+	/**
+	 * \brief Writes rectangles into a binary rectangle file
+	 *
+	 * The rectangles are converted with toRect and streamed into the file one by one. Positions are written as they
+	 * are, the bins are set to InvalidBin.
+	 *
+	 * \param path Path of the file. It's overwritten if it exists.
+	 * \param collection Collection of rectangles e.g. vector, list, array
+	 * \throws BinaryFormatError if the file can't be written
+	 */
+	template<typename Collection>
+	void writeBinaryFile(const std::string& path, const Collection& collection) {
+		writeBinaryFile(path, std::begin(collection), std::end(collection));
+	}
+
+	/**
+	 * @}
+	 */
+}
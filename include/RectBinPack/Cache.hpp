@@ -0,0 +1,359 @@
+/**
+ * \file Cache.hpp
+ * Cache for packing results keyed by the configuration and the rectangle sizes
+ */
+
+#pragma once
+
+#include "RectBinPack.hpp"
+#include "Guillotine.hpp"
+#include "MaxRects.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RectBinPack {
+	/**
+	 * \addtogroup Cache
+	 * @{
+	 */
+
+	/// Stored result of a single packing run
+	struct CacheEntry {
+		Result result; ///< Result of the packing function
+		std::vector<BinRect> rects; ///< Packed rectangles in the order of the input
+	};
+
+	/// Interface for storing cache entries
+	class CacheStore {
+	public:
+		virtual ~CacheStore() = default;
+
+		/**
+		 * \brief Loads the entry stored for \p key
+		 *
+		 * \returns True if an entry was found and written into \p entry
+		 */
+		virtual bool load(std::uint64_t key, CacheEntry& entry) = 0;
+
+		/// Stores \p entry for \p key, replacing the previous one
+		virtual void store(std::uint64_t key, const CacheEntry& entry) = 0;
+	};
+
+	/// Keeps cache entries in memory and drops the least recently used one once the capacity is reached
+	class MemoryCacheStore: public CacheStore {
+	public:
+		/// Constructs the store with room for \p capacity entries. Defaults to 1 if 0
+		explicit MemoryCacheStore(std::size_t capacity):
+			m_capacity(std::max(std::size_t(1), capacity)) { }
+
+		bool load(std::uint64_t key, CacheEntry& entry) override {
+			const auto it = m_entries.find(key);
+
+			if (it == m_entries.end())
+				return false;
+
+			// Move the entry to the front of the list, it's the most recently used one now
+			m_order.splice(m_order.begin(), m_order, it->second);
+			entry = it->second->second;
+			return true;
+		}
+
+		void store(std::uint64_t key, const CacheEntry& entry) override {
+			const auto it = m_entries.find(key);
+
+			if (it != m_entries.end()) {
+				it->second->second = entry;
+				m_order.splice(m_order.begin(), m_order, it->second);
+				return;
+			}
+
+			if (m_entries.size() >= m_capacity) {
+				m_entries.erase(m_order.back().first);
+				m_order.pop_back();
+			}
+
+			m_order.emplace_front(key, entry);
+			m_entries[key] = m_order.begin();
+		}
+
+		/// Returns the number of stored entries
+		std::size_t size() const {
+			return m_entries.size();
+		}
+
+	private:
+		using List = std::list<std::pair<std::uint64_t, CacheEntry>>;
+
+		std::size_t m_capacity;
+		List m_order;
+		std::unordered_map<std::uint64_t, List::iterator> m_entries;
+	};
+
+	/**
+	 * \brief Keeps cache entries as files in a directory
+	 *
+	 * Every entry is stored in its own file named after the key. Files are written to a temporary name first and
+	 * renamed afterwards, so other processes never see partially written entries. Unreadable files are treated as
+	 * misses. The directory must exist.
+	 */
+	class DirectoryCacheStore: public CacheStore {
+	public:
+		/// Constructs the store for \p directory
+		explicit DirectoryCacheStore(std::string directory):
+			m_directory(std::move(directory)) {
+
+			if (!m_directory.empty() && m_directory.back() != '/' && m_directory.back() != '\\')
+				m_directory.push_back('/');
+		}
+
+		bool load(std::uint64_t key, CacheEntry& entry) override {
+			std::ifstream stream(path(key), std::ios::binary);
+			unsigned char header[headerSize];
+
+			if (!stream.read(reinterpret_cast<char*>(header), headerSize))
+				return false;
+
+			if (std::memcmp(header, "RBPC", 4) != 0 || decode<std::uint32_t>(header + 4) != version)
+				return false;
+
+			const auto count = decode<std::uint64_t>(header + 16);
+
+			// A corrupt count must not allocate more records than the file holds
+			const auto start = stream.tellg();
+			stream.seekg(0, std::ios::end);
+			const auto end = stream.tellg();
+			stream.seekg(start);
+
+			if (start < 0 || end < start || count > (std::uint64_t) (end - start) / recordSize)
+				return false;
+
+			std::vector<unsigned char> records((std::size_t) count * recordSize);
+
+			if (!stream.read(reinterpret_cast<char*>(records.data()), records.size()))
+				return false;
+
+			entry.result = { decode<std::uint32_t>(header + 8) != 0, decode<std::uint32_t>(header + 12), 0 };
+			entry.rects.clear();
+			entry.rects.reserve((std::size_t) count);
+
+			for (auto record = records.data(); record != records.data() + records.size(); record += recordSize)
+				entry.rects.push_back({
+					{
+						decode<std::uint32_t>(record), decode<std::uint32_t>(record + 4),
+						decode<std::uint32_t>(record + 8), decode<std::uint32_t>(record + 12)
+					},
+					decode<std::uint32_t>(record + 16), decode<std::uint32_t>(record + 20) != 0
+				});
+
+			return true;
+		}
+
+		void store(std::uint64_t key, const CacheEntry& entry) override {
+			const auto target = path(key);
+			const auto temporary = temporaryPath(target);
+
+			std::vector<unsigned char> data { 'R', 'B', 'P', 'C' };
+			data.reserve(headerSize + entry.rects.size() * recordSize);
+
+			encode(data, version);
+			encode(data, entry.result.failed ? 1u : 0u);
+			encode(data, entry.result.numBins);
+			encode(data, (std::uint64_t) entry.rects.size());
+
+			for (auto& rect : entry.rects) {
+				encode(data, rect.rect.x);
+				encode(data, rect.rect.y);
+				encode(data, rect.rect.width);
+				encode(data, rect.rect.height);
+				encode(data, rect.bin);
+				encode(data, rect.flipped ? 1u : 0u);
+			}
+
+			{
+				std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+				stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+				if (!stream) {
+					stream.close();
+					std::remove(temporary.c_str());
+					return;
+				}
+			}
+
+			// Renaming onto an existing file fails on some platforms
+			if (std::rename(temporary.c_str(), target.c_str()) != 0) {
+				std::remove(target.c_str());
+
+				if (std::rename(temporary.c_str(), target.c_str()) != 0)
+					std::remove(temporary.c_str());
+			}
+		}
+
+		/// Returns the path of the file for \p key
+		std::string path(std::uint64_t key) const {
+			char name[17];
+			std::snprintf(name, sizeof(name), "%016llx", (unsigned long long) key);
+			return m_directory + name + ".rbpc";
+		}
+
+	private:
+		static const std::uint32_t version = 1;
+
+		/// Returns a unique temporary name next to \p target, so concurrent writers never share a file
+		static std::string temporaryPath(const std::string& target) {
+			std::random_device device;
+
+			const auto value =
+				(((std::uint64_t) device() << 32) | device()) ^
+				(std::uint64_t) std::chrono::high_resolution_clock::now().time_since_epoch().count();
+
+			char suffix[18];
+			std::snprintf(suffix, sizeof(suffix), ".%016llx", (unsigned long long) value);
+			return target + suffix + ".tmp";
+		}
+
+		/// Files start with the magic number, the version, failed, numBins and the number of records
+		static const std::size_t headerSize = 24;
+
+		/// Records hold x, y, width, height, bin and flipped
+		static const std::size_t recordSize = 24;
+
+		/// Appends \p value to \p data in little endian order, so files can be shared between platforms
+		template<typename T>
+		static void encode(std::vector<unsigned char>& data, T value) {
+			for (auto i = 0u; i < sizeof(T) * 8; i += 8)
+				data.push_back((unsigned char) ((std::uint64_t) value >> i));
+		}
+
+		/// Reads a value written by encode
+		template<typename T>
+		static T decode(const unsigned char* data) {
+			std::uint64_t value = 0;
+
+			for (auto i = 0u; i < sizeof(T); ++i)
+				value |= (std::uint64_t) data[i] << (i * 8);
+
+			return (T) value;
+		}
+
+		std::string m_directory;
+	};
+
+	/**
+	 * \brief Returns the cache key for packing the rectangles with \p config
+	 *
+	 * The key covers every option of the configuration and the sizes of the rectangles in order.
+	 *
+	 * \param config Configuration of the algorithm
+	 * \param begin Begin iterator of the sequence of rectangles
+	 * \param end End iterator of the sequence of rectangles
+	 */
+	template<typename Configuration, typename It, typename ItEnd>
+	std::uint64_t getCacheKey(const Configuration& config, It begin, ItEnd end) {
+		Internal::Hasher hasher;
+		Internal::hash(hasher, config);
+
+		for (auto it = begin; it != end; ++it) {
+			const auto rect = toRect(*it);
+
+			hasher.add(rect.width);
+			hasher.add(rect.height);
+		}
+
+		return hasher.value();
+	}
+
+	/**
+	 * \brief Packs rectangles or returns the stored placements if they were packed the same way before
+	 *
+	 * Packing is deterministic, so a stored result is the same as packing again. On a miss the rectangles are packed
+	 * with the function matching the configuration type (e.g. packMaxRects, packGuillotine) and the result is stored.
+	 * The sizes of a stored entry are compared with the rectangles before it's used, so hash collisions are detected.
+	 * Exceptions of the packing function are passed on and nothing is stored.
+	 *
+	 * \param store Store of the cache entries
+	 * \param config Configuration of the algorithm
+	 * \param begin Begin iterator of the sequence of rectangles
+	 * \param end End iterator of the sequence of rectangles
+	 * \param size Size of the sequence. Helps the internal vector reserve enough space, can be set to 0
+	 * \returns If the packing suceeded and the number of used bins
+	 */
+	template<typename Configuration, typename It, typename ItEnd>
+	Result packCached(CacheStore& store, const Configuration& config, It begin, ItEnd end, std::size_t size = 0) {
+		const auto key = getCacheKey(config, begin, end);
+
+		CacheEntry entry;
+		std::vector<Rect> sizes;
+		sizes.reserve(size);
+
+		for (auto it = begin; it != end; ++it)
+			sizes.push_back(toRect(*it));
+
+		const auto matches = [&]() {
+			if (entry.rects.size() != sizes.size())
+				return false;
+
+			for (std::size_t i = 0; i < sizes.size(); ++i) {
+				const auto& rect = entry.rects[i];
+				const auto packed = rect.flipped ? rect.rect.flipped() : rect.rect;
+
+				// Empty rectangles are stored as 0x0 by the packing functions
+				const auto isEmpty = sizes[i].width == 0 || sizes[i].height == 0;
+
+				if (packed.width != (isEmpty ? 0 : sizes[i].width) || packed.height != (isEmpty ? 0 : sizes[i].height))
+					return false;
+			}
+
+			return true;
+		};
+
+		if (!store.load(key, entry) || !matches()) {
+			entry.rects.clear();
+			entry.rects.reserve(sizes.size());
+
+			for (auto& rect : sizes)
+				entry.rects.push_back({ { 0, 0, rect.width, rect.height }, InvalidBin, false });
+
+			entry.result = Internal::pack(config, entry.rects.begin(), entry.rects.end(), entry.rects.size());
+			store.store(key, entry);
+		}
+
+		auto rect = entry.rects.begin();
+
+		for (auto it = begin; it != end; ++it, ++rect)
+			fromBinRect(*it, *rect);
+
+		return entry.result;
+	}
+
+	/**
+	 * \brief Packs rectangles or returns the stored placements if they were packed the same way before
+	 *
+	 * Packing is deterministic, so a stored result is the same as packing again. On a miss the rectangles are packed
+	 * with the function matching the configuration type (e.g. packMaxRects, packGuillotine) and the result is stored.
+	 * The sizes of a stored entry are compared with the rectangles before it's used, so hash collisions are detected.
+	 * Exceptions of the packing function are passed on and nothing is stored.
+	 *
+	 * \param store Store of the cache entries
+	 * \param config Configuration of the algorithm
+	 * \param collection Collection of rectangles e.g. vector, list, array
+	 * \returns If the packing suceeded and the number of used bins
+	 */
+	template<typename Configuration, typename Collection>
+	Result packCached(CacheStore& store, const Configuration& config, Collection& collection) {
+		return packCached(store, config, std::begin(collection), std::end(collection), Internal::size(collection));
+	}
+
+	/**
+	 * @}
+	 */
+}
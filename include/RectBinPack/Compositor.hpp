@@ -0,0 +1,237 @@
+/**
+ * \file Compositor.hpp
+ * Copies source images into the bins of a packed atlas
+ */
+
+#pragma once
+
+#include "RectBinPack.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace RectBinPack {
+	/**
+	 * \addtogroup Compositor
+	 * @{
+	 */
+
+	/// Exception thrown by the compositor if the rectangles don't match the images
+	class CompositorError: public std::runtime_error {
+	public:
+		/// Construct from message string
+		explicit CompositorError(const char* msg):
+			std::runtime_error(msg) { }
+
+		/// Construct from message string
+		explicit CompositorError(const std::string& msg):
+			std::runtime_error(msg) { }
+	};
+
+	/// Source image which is copied into the atlas
+	struct SourceImage {
+		const void* data; ///< Pointer to the first pixel
+		unsigned int width; ///< Width in pixels
+		unsigned int height; ///< Height in pixels
+		std::size_t stride; ///< Distance between two rows in bytes
+	};
+
+	/// Image of a single bin of the atlas
+	struct BinImage {
+		void* data; ///< Pointer to the first pixel
+		unsigned int width; ///< Width in pixels
+		unsigned int height; ///< Height in pixels
+		std::size_t stride; ///< Distance between two rows in bytes
+	};
+
+	/// Configuration of the compositor
+	struct CompositorConfiguration {
+		unsigned int pixelSize; ///< Size of a single pixel in bytes. It's the same for source and bin images.
+		unsigned int numThreads; ///< Maximum number of threads. Uses the number of hardware threads if 0.
+	};
+
+	/// \cond INTERNAL
+	namespace Internal {
+		/// Edge length of the blocks in pixels used for transposing images
+		const unsigned int transposeBlockSize = 16;
+
+		/// Copies the image row by row
+		inline void copy(unsigned char* dst, std::size_t dstStride, const SourceImage& src, std::size_t pixelSize) {
+			const auto data = static_cast<const unsigned char*>(src.data);
+			const auto rowSize = src.width * pixelSize;
+
+			for (auto y = 0u; y < src.height; ++y)
+				std::memcpy(dst + y * dstStride, data + y * src.stride, rowSize);
+		}
+
+		/**
+		 * \brief Copies the transposed image in blocks, so that reads and writes both stay within a few cache lines
+		 *
+		 * \tparam Size Size of a pixel known at compile time. Uses \p pixelSize if 0.
+		 */
+		template<std::size_t Size>
+		void transpose(unsigned char* dst, std::size_t dstStride, const SourceImage& src, std::size_t pixelSize) {
+			const auto size = Size != 0 ? Size : pixelSize;
+			const auto data = static_cast<const unsigned char*>(src.data);
+
+			for (auto blockY = 0u; blockY < src.height; blockY += transposeBlockSize) {
+				const auto maxY = std::min(blockY + transposeBlockSize, src.height);
+
+				for (auto blockX = 0u; blockX < src.width; blockX += transposeBlockSize) {
+					const auto maxX = std::min(blockX + transposeBlockSize, src.width);
+
+					for (auto y = blockY; y < maxY; ++y) {
+						const auto row = data + y * src.stride;
+
+						for (auto x = blockX; x < maxX; ++x)
+							std::memcpy(dst + x * dstStride + y * size, row + x * size, size);
+					}
+				}
+			}
+		}
+
+		/// Transposes the image with a specialized copy for common pixel sizes
+		inline void transpose(unsigned char* dst, std::size_t dstStride, const SourceImage& src, std::size_t pixelSize) {
+			switch (pixelSize) {
+			case 1:
+				return transpose<1>(dst, dstStride, src, pixelSize);
+			case 2:
+				return transpose<2>(dst, dstStride, src, pixelSize);
+			case 3:
+				return transpose<3>(dst, dstStride, src, pixelSize);
+			case 4:
+				return transpose<4>(dst, dstStride, src, pixelSize);
+			case 8:
+				return transpose<8>(dst, dstStride, src, pixelSize);
+			case 16:
+				return transpose<16>(dst, dstStride, src, pixelSize);
+			default:
+				return transpose<0>(dst, dstStride, src, pixelSize);
+			}
+		}
+
+		/// Copies \p src into the bin at the position of \p rect
+		inline void blit(const BinImage& bin, const BinRect& rect, const SourceImage& src, std::size_t pixelSize) {
+			const auto dst = static_cast<unsigned char*>(bin.data) + rect.rect.y * bin.stride + rect.rect.x * pixelSize;
+
+			if (rect.flipped)
+				transpose(dst, bin.stride, src, pixelSize);
+			else
+				copy(dst, bin.stride, src, pixelSize);
+		}
+	}
+	/// \endcond
+
+	/**
+	 * \brief Copies the source images into the bins at their packed positions
+	 *
+	 * Every rectangle is paired with the source image at the same position in the sequence. Rectangles with
+	 * InvalidBin or an empty size are skipped. Flipped rectangles are transposed, so the pixel at (x, y) of the
+	 * source ends up at (y, x) relative to the rectangle. Bins are processed in parallel, the pixels outside of the
+	 * rectangles are left untouched.
+	 *
+	 * All rectangles are checked before anything is copied.
+	 *
+	 * \param config Configuration of the compositor
+	 * \param begin Begin iterator of the sequence of packed rectangles (BinRect)
+	 * \param end End iterator of the sequence of packed rectangles (BinRect)
+	 * \param sources Iterator to the first source image (SourceImage) matching \p begin
+	 * \param bins Images of the bins indexed by BinRect::bin
+	 * \throws CompositorError if a rectangle doesn't match its source image or lies outside of its bin
+	 */
+	template<typename It, typename ItEnd, typename SourceIt>
+	void composite(const CompositorConfiguration& config, It begin, ItEnd end, SourceIt sources, const std::vector<BinImage>& bins) {
+		struct Item {
+			BinRect rect;
+			SourceImage source;
+		};
+
+		std::vector<std::vector<Item>> items(bins.size());
+
+		for (auto it = begin; it != end; ++it, ++sources) {
+			const BinRect& rect = *it;
+			const SourceImage& source = *sources;
+
+			if (rect.bin == InvalidBin || rect.rect.width == 0 || rect.rect.height == 0)
+				continue;
+
+			if (rect.bin >= bins.size())
+				throw CompositorError("bin index out of range");
+
+			const auto size = rect.flipped ? rect.rect.flipped() : rect.rect;
+
+			if (size.width != source.width || size.height != source.height)
+				throw CompositorError("source image doesn't match the size of the rectangle");
+
+			if (rect.rect.right() > bins[rect.bin].width || rect.rect.bottom() > bins[rect.bin].height)
+				throw CompositorError("rectangle lies outside of the bin image");
+
+			items[rect.bin].push_back({ rect, source });
+		}
+
+		if (items.empty())
+			return;
+
+		std::atomic<std::size_t> next(0);
+
+		// Bins never share pixels, so every thread takes whole bins
+		const auto work = [&]() {
+			for (auto bin = next++; bin < items.size(); bin = next++)
+				for (auto& item : items[bin])
+					Internal::blit(bins[bin], item.rect, item.source, config.pixelSize);
+		};
+
+		auto numThreads = config.numThreads != 0 ? config.numThreads : std::thread::hardware_concurrency();
+		numThreads = (unsigned int) std::min<std::size_t>(std::max(numThreads, 1u), items.size());
+
+		std::vector<std::thread> threads;
+		threads.reserve(numThreads - 1);
+
+		try {
+			for (auto i = 1u; i < numThreads; ++i)
+				threads.emplace_back(work);
+		}
+		catch (const std::system_error&) {
+			// Bins are taken from a shared counter, so the threads which did start do the remaining work
+		}
+
+		work();
+
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	/**
+	 * \brief Copies the source images into the bins at their packed positions
+	 *
+	 * Every rectangle is paired with the source image at the same position in the sequence. Rectangles with
+	 * InvalidBin or an empty size are skipped. Flipped rectangles are transposed, so the pixel at (x, y) of the
+	 * source ends up at (y, x) relative to the rectangle. Bins are processed in parallel, the pixels outside of the
+	 * rectangles are left untouched.
+	 *
+	 * All rectangles are checked before anything is copied.
+	 *
+	 * \param config Configuration of the compositor
+	 * \param rects Collection of packed rectangles (BinRect) e.g. vector, list, array
+	 * \param sources Collection of source images (SourceImage) in the same order as \p rects
+	 * \param bins Images of the bins indexed by BinRect::bin
+	 * \throws CompositorError if the collections differ in size, a rectangle doesn't match its source image or lies
+	 * outside of its bin
+	 */
+	template<typename Collection, typename SourceCollection>
+	void composite(const CompositorConfiguration& config, const Collection& rects, const SourceCollection& sources, const std::vector<BinImage>& bins) {
+		if (Internal::size(rects) != Internal::size(sources))
+			throw CompositorError("number of rectangles and source images differ");
+
+		composite(config, std::begin(rects), std::end(rects), std::begin(sources), bins);
+	}
+
+	/**
+	 * @}
+	 */
+}
@@ -0,0 +1,536 @@
+/**
+ * \file Exact.hpp
+ * Implementation of an exact branch and bound algorithm for small instances
+ */
+
+#pragma once
+
+#include "RectBinPack.hpp"
+#include "MaxRects.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace RectBinPack {
+	/**
+	 * \addtogroup Exact
+	 * @{
+	 */
+
+	/// Configuration for the packing function
+	struct ExactConfiguration {
+		unsigned int width; ///< Width of the bin
+		unsigned int height; ///< Height of the bin
+		int minBins; ///< Minimum number of bins. Defaults to 1 if less then 1
+		int maxBins; ///< Maximum number of bins. Defaults to UnlimitedBins if less than 1
+		bool canFlip; ///< Allows for flipping of the rectangles
+		unsigned long nodeLimit; ///< Maximum number of search nodes. Unlimited if 0
+		unsigned int timeLimit; ///< Maximum search time in milliseconds. Unlimited if 0
+	};
+
+	/// \cond INTERNAL
+	namespace Internal {
+		/**
+		 * \brief Implementation of the exact branch and bound algorithm
+		 *
+		 * The search starts with the best solution of the %MaxRects heuristics and tries to find one with fewer bins
+		 * until the lower bound is reached. Rectangles are placed in order of decreasing area at normal positions,
+		 * which are all sums of rectangle widths (or heights). Every packing can be moved to the top left until all
+		 * rectangles are at such positions, so the search is complete if it isn't interrupted by a limit.
+		 */
+		template<typename It>
+		class Exact {
+		public:
+			/// Type of the iterator's value
+			using Type = typename std::iterator_traits<It>::value_type;
+
+			/**
+			 * \brief Constructs the class and creates vector of items
+			 *
+			 * \param begin Begin iterator of the sequence
+			 * \param end End iterator of the sequence
+			 * \param size Size of the sequence. Helps the internal vector determine the size, can be set to 0
+			 * \param config Configuration to use for packing
+			 * \throws RectangleTooLargeError if the rectangle is too big to fit into any bin
+			 */
+			template<typename ItEnd>
+			Exact(It begin, ItEnd end, std::size_t size, const ExactConfiguration& config):
+				m_config(config) {
+
+				m_items.reserve(size);
+
+				for (auto it = begin; it != end; ++it) {
+					const auto rect = toRect(*it);
+
+					if (rect.width > config.width || rect.height > config.height)
+						if (!config.canFlip || (rect.height > config.width || rect.width > config.height))
+							throw RectangleTooLargeError("rectangle is too large");
+
+					if (rect.width > 0 && rect.height > 0)
+						m_items.push_back({ it, rect.width, rect.height });
+					else
+						fromBinRect(*it, { { 0, 0, 0, 0 }, InvalidBin, false });
+				}
+
+				// Big items first, identical items next to each other
+				std::stable_sort(m_items.begin(), m_items.end(), [](const Item& a, const Item& b) {
+					const auto areaA = (std::uint64_t) a.width * a.height;
+					const auto areaB = (std::uint64_t) b.width * b.height;
+
+					if (areaA != areaB)
+						return areaA > areaB;
+
+					return a.width != b.width ? a.width > b.width : a.height > b.height;
+				});
+			}
+
+			/**
+			 * \brief Packs the rectangles
+			 *
+			 * \returns true, if packing succeeded
+			 */
+			bool pack() {
+				const auto minBins = (unsigned int) std::max(1, m_config.minBins);
+
+				m_numBins = minBins;
+
+				if (m_items.empty())
+					return true;
+
+				m_lowerBound = std::max(minBins, getLowerBound());
+
+				packGreedy();
+
+				if (m_bestBins > m_lowerBound) {
+					prepareSearch();
+
+					m_limit = m_bestBins - 1;
+					m_nodes = 0;
+					m_aborted = false;
+					m_start = std::chrono::steady_clock::now();
+
+					// Every solution found lowers the limit, so the search ends when it drops below the lower bound
+					search(0, 0);
+				}
+
+				m_numBins = std::max(minBins, m_bestBins);
+
+				const auto maxBins = m_config.maxBins > 0 ? (unsigned int) m_config.maxBins : m_numBins;
+				auto succeeded = true;
+
+				for (auto i = 0u; i < m_items.size(); ++i) {
+					const auto& item = m_items[i];
+					const auto& placement = m_best[i];
+
+					if (placement.bin >= maxBins) {
+						fromBinRect(*item.it, { toRect(*item.it), InvalidBin, false });
+						succeeded = false;
+						continue;
+					}
+
+					const Rect rect { placement.x, placement.y, item.width, item.height };
+
+					fromBinRect(*item.it, {
+						placement.flip ? rect.flipped() : rect,
+						placement.bin,
+						placement.flip
+					});
+				}
+
+				if (!succeeded)
+					m_numBins = maxBins;
+
+				return succeeded;
+			}
+
+			/// Returns the number of bins used
+			unsigned int numBins() const {
+				return m_numBins;
+			}
+
+		private:
+			// Maximum number of item checks for calculating the lower bound
+			static const std::uint64_t maxBoundWork = 1 << 24;
+
+			struct Item {
+				It it;
+				unsigned int width;
+				unsigned int height;
+			};
+
+			struct Placement {
+				unsigned int bin;
+				unsigned int x;
+				unsigned int y;
+				bool flip;
+			};
+
+			/// Checks if \p item fits into the bin with the given orientation
+			bool fits(const Item& item, bool flip) const {
+				return flip ?
+					m_config.canFlip && item.height <= m_config.width && item.width <= m_config.height :
+					item.width <= m_config.width && item.height <= m_config.height;
+			}
+
+			/// Checks if every orientation in which \p item fits into the bin satisfies \p pred
+			template<typename Pred>
+			bool allOrientations(const Item& item, Pred pred) const {
+				return (!fits(item, false) || pred(item.width, item.height)) &&
+					(!fits(item, true) || pred(item.height, item.width));
+			}
+
+			/**
+			 * \brief Calculates the L2 lower bound of Martello and Vigo
+			 *
+			 * Items which are larger than half the bin in both directions need a bin each. Items in K1 (larger than
+			 * W - p and H - q) also leave no room for items at least p wide and q high (K3), which have to fit into
+			 * the space left next to the remaining big items (K2) or into additional bins. With p = q = 0 this is
+			 * the simple area bound.
+			 */
+			unsigned int getLowerBound() const {
+				const auto binArea = (std::uint64_t) m_config.width * m_config.height;
+
+				std::vector<unsigned int> ps { 0 }, qs { 0 };
+
+				for (auto& item : m_items) {
+					for (auto size : { item.width, item.height }) {
+						if (size <= m_config.width / 2)
+							ps.push_back(size);
+
+						if (size <= m_config.height / 2)
+							qs.push_back(size);
+					}
+				}
+
+				std::sort(ps.begin(), ps.end());
+				ps.erase(std::unique(ps.begin(), ps.end()), ps.end());
+				std::sort(qs.begin(), qs.end());
+				qs.erase(std::unique(qs.begin(), qs.end()), qs.end());
+
+				// Fall back to the area bound if there are too many combinations
+				if ((std::uint64_t) ps.size() * qs.size() * m_items.size() > maxBoundWork)
+					ps.resize(1), qs.resize(1);
+
+				auto bound = 0u;
+
+				for (auto p : ps) {
+					for (auto q : qs) {
+						auto numK1 = 0u, numK2 = 0u;
+						std::uint64_t areaK2 = 0, areaK3 = 0;
+
+						for (auto& item : m_items) {
+							const auto area = (std::uint64_t) item.width * item.height;
+
+							const auto big = allOrientations(item, [&](unsigned int w, unsigned int h) {
+								return w > m_config.width / 2 && h > m_config.height / 2;
+							});
+
+							if (big) {
+								const auto k1 = allOrientations(item, [&](unsigned int w, unsigned int h) {
+									return w > m_config.width - p && h > m_config.height - q;
+								});
+
+								if (k1)
+									++numK1;
+								else {
+									++numK2;
+									areaK2 += area;
+								}
+							}
+							else {
+								const auto k3 = allOrientations(item, [&](unsigned int w, unsigned int h) {
+									return w >= p && h >= q;
+								});
+
+								if (k3)
+									areaK3 += area;
+							}
+						}
+
+						const auto freeK2 = numK2 * binArea - areaK2;
+						const auto extra = areaK3 > freeK2 ? (areaK3 - freeK2 + binArea - 1) / binArea : 0;
+
+						bound = std::max(bound, numK1 + numK2 + (unsigned int) extra);
+					}
+				}
+
+				return bound;
+			}
+
+			/// Uses the best result of the %MaxRects heuristics as the initial solution
+			void packGreedy() {
+				const MaxRectsHeuristic heuristics[] {
+					MaxRectsHeuristic::BestShortSideFit,
+					MaxRectsHeuristic::BestLongSideFit,
+					MaxRectsHeuristic::BestAreaFit,
+					MaxRectsHeuristic::BottomLeftRule
+				};
+
+				m_bestBins = std::numeric_limits<unsigned int>::max();
+
+				for (auto heuristic : heuristics) {
+					std::vector<BinRect> rects;
+					rects.reserve(m_items.size());
+
+					for (auto& item : m_items)
+						rects.push_back({ { 0, 0, item.width, item.height }, 0, false });
+
+					MaxRectsConfiguration config {};
+					config.width = m_config.width;
+					config.height = m_config.height;
+					config.minBins = 1;
+					config.maxBins = UnlimitedBins;
+					config.canFlip = m_config.canFlip;
+					config.rectHeuristic = heuristic;
+
+					const auto result = packMaxRects(config, rects);
+
+					if (result.numBins >= m_bestBins)
+						continue;
+
+					m_bestBins = result.numBins;
+					m_best.clear();
+
+					for (auto& rect : rects)
+						m_best.push_back({ rect.bin, rect.rect.x, rect.rect.y, rect.flipped });
+				}
+			}
+
+			/// Calculates the normal positions and the area of the items left after each item
+			void prepareSearch() {
+				m_normalX = getNormalPositions(m_config.width, true);
+				m_normalY = getNormalPositions(m_config.height, false);
+
+				m_remainingArea.assign(m_items.size() + 1, 0);
+
+				for (auto i = m_items.size(); i-- > 0;)
+					m_remainingArea[i] = m_remainingArea[i + 1] + (std::uint64_t) m_items[i].width * m_items[i].height;
+
+				m_current.assign(m_items.size(), {});
+				m_binRects.assign(m_bestBins, {});
+				m_binArea.assign(m_bestBins, 0);
+				m_openBins = 0;
+			}
+
+			/// Returns all sums of item widths (\p horizontal) or heights up to \p size
+			std::vector<unsigned int> getNormalPositions(unsigned int size, bool horizontal) const {
+				std::vector<char> reachable(size + 1, 0);
+				reachable[0] = 1;
+
+				for (auto& item : m_items) {
+					const auto length = horizontal ? item.width : item.height;
+					const auto flippedLength = horizontal ? item.height : item.width;
+					auto next = reachable;
+
+					for (auto i = 0u; i <= size; ++i) {
+						if (!reachable[i])
+							continue;
+
+						if (length <= size - i)
+							next[i + length] = 1;
+
+						if (m_config.canFlip && flippedLength <= size - i)
+							next[i + flippedLength] = 1;
+					}
+
+					reachable.swap(next);
+				}
+
+				std::vector<unsigned int> positions;
+
+				for (auto i = 0u; i <= size; ++i)
+					if (reachable[i])
+						positions.push_back(i);
+
+				return positions;
+			}
+
+			bool limitReached() {
+				++m_nodes;
+
+				if (m_config.nodeLimit > 0 && m_nodes > m_config.nodeLimit)
+					m_aborted = true;
+
+				if (m_config.timeLimit > 0 && (m_nodes & 0xFF) == 0) {
+					const auto elapsed = std::chrono::steady_clock::now() - m_start;
+
+					if (elapsed >= std::chrono::milliseconds(m_config.timeLimit))
+						m_aborted = true;
+				}
+
+				return m_aborted;
+			}
+
+			/// Checks if the current branch can't lead to a better solution anymore
+			bool pruned() const {
+				return m_aborted || m_limit < m_lowerBound || m_openBins > m_limit;
+			}
+
+			void search(std::size_t index, std::uint64_t placedArea) {
+				if (pruned())
+					return;
+
+				if (index == m_items.size()) {
+					m_best = m_current;
+					m_bestBins = m_openBins;
+					m_limit = m_bestBins - 1;
+					return;
+				}
+
+				if (limitReached())
+					return;
+
+				const auto binArea = (std::uint64_t) m_config.width * m_config.height;
+
+				// The remaining items have to fit into the space left in the allowed bins
+				if (m_remainingArea[index] > m_limit * binArea - placedArea)
+					return;
+
+				const auto& item = m_items[index];
+				const auto itemArea = (std::uint64_t) item.width * item.height;
+
+				// Identical items are interchangeable, so they are placed in increasing order only
+				const auto identical = index > 0 &&
+					m_items[index - 1].width == item.width && m_items[index - 1].height == item.height;
+				const auto& previous = m_current[index > 0 ? index - 1 : 0];
+
+				// Only one new bin is tried, since all empty bins are the same
+				for (auto bin = identical ? previous.bin : 0u; bin <= m_openBins && bin < m_limit; ++bin) {
+					if (m_binArea[bin] + itemArea > binArea)
+						continue;
+
+					for (auto flip : { false, true }) {
+						if (!fits(item, flip) || (flip && item.width == item.height))
+							continue;
+
+						const auto w = flip ? item.height : item.width;
+						const auto h = flip ? item.width : item.height;
+
+						for (auto y : m_normalY) {
+							if (y + h > m_config.height || pruned())
+								break;
+
+							auto xIt = m_normalX.begin();
+
+							while (xIt != m_normalX.end() && *xIt + w <= m_config.width && !pruned()) {
+								const Rect rect { *xIt, y, w, h };
+
+								if (identical && bin == previous.bin && (y < previous.y || (y == previous.y && *xIt <= previous.x))) {
+									++xIt;
+									continue;
+								}
+
+								// Skip all positions covered by the overlapping rectangle
+								const auto overlap = std::find_if(m_binRects[bin].begin(), m_binRects[bin].end(), [&](const Rect& other) {
+									return rect.intersect(other);
+								});
+
+								if (overlap != m_binRects[bin].end()) {
+									xIt = std::lower_bound(xIt, m_normalX.end(), overlap->right());
+									continue;
+								}
+
+								m_current[index] = { bin, rect.x, rect.y, flip };
+								m_binRects[bin].push_back(rect);
+								m_binArea[bin] += itemArea;
+
+								if (bin == m_openBins)
+									++m_openBins;
+
+								search(index + 1, placedArea + itemArea);
+
+								m_binRects[bin].pop_back();
+								m_binArea[bin] -= itemArea;
+
+								if (m_binRects[bin].empty())
+									--m_openBins;
+
+								++xIt;
+							}
+						}
+					}
+				}
+			}
+
+			const ExactConfiguration& m_config;
+			std::vector<Item> m_items;
+			std::vector<Placement> m_best;
+			std::vector<Placement> m_current;
+			std::vector<std::vector<Rect>> m_binRects;
+			std::vector<std::uint64_t> m_binArea;
+			std::vector<std::uint64_t> m_remainingArea;
+			std::vector<unsigned int> m_normalX;
+			std::vector<unsigned int> m_normalY;
+			std::chrono::steady_clock::time_point m_start;
+			unsigned long m_nodes = 0;
+			unsigned int m_bestBins = 0;
+			unsigned int m_lowerBound = 0;
+			unsigned int m_openBins = 0;
+			unsigned int m_limit = 0;
+			unsigned int m_numBins = 0;
+			bool m_aborted = false;
+		};
+	}
+	/// \endcond
+
+	/**
+	 * \brief Packs rectangles using an exact branch and bound algorithm
+	 *
+	 * Finds the minimal number of bins for small sets of rectangles (up to about 30). The search starts from the best
+	 * %MaxRects solution and uses the area and L2 lower bounds to prune. If the node or time limit is hit, the best
+	 * solution found so far is used, which is never worse than the %MaxRects heuristics.
+	 *
+	 * The conversion to and from the rectangles uses functions to transform them into and from the internal types.
+	 * They are called toRect and fromBinRect. They have to be overloaded for each custom type. The index of empty
+	 * rectangles is always set to InvalidBin.
+	 *
+	 * \param config Configuration to use for packing
+	 * \param begin Begin iterator of the sequence of rectangles
+	 * \param end End iterator of the sequence of rectangles
+	 * \param size Size of the sequence. Helps the internal vector reserve enough space, can be set to 0
+	 * \returns If the packing suceeded and the number of used bins
+	 * \throws std::runtime_error if the rectangle is too big to fit into any bin
+	 */
+	template<typename It, typename ItEnd>
+	Result packExact(const ExactConfiguration& config, It begin, ItEnd end, std::size_t size = 0) {
+		Internal::Exact<It> exact(begin, end, size, config);
+		return { !exact.pack(), exact.numBins(), 0 };
+	}
+
+	/**
+	 * \brief Packs rectangles using an exact branch and bound algorithm
+	 *
+	 * Finds the minimal number of bins for small sets of rectangles (up to about 30). The search starts from the best
+	 * %MaxRects solution and uses the area and L2 lower bounds to prune. If the node or time limit is hit, the best
+	 * solution found so far is used, which is never worse than the %MaxRects heuristics.
+	 *
+	 * The conversion to and from the rectangles uses functions to transform them into and from the internal types.
+	 * They are called toRect and fromBinRect. They have to be overloaded for each custom type. The index of empty
+	 * rectangles is always set to InvalidBin.
+	 *
+	 * \param config Configuration to use for packing
+	 * \param collection Collection of rectangles e.g. vector, list, array
+	 * \returns If the packing suceeded and the number of used bins
+	 * \throws std::runtime_error if the rectangle is too big to fit into any bin
+	 */
+	template<typename Collection>
+	Result packExact(const ExactConfiguration& config, Collection& collection) {
+		return packExact(config, std::begin(collection), std::end(collection), Internal::size(collection));
+	}
+
+	/// \cond INTERNAL
+	namespace Internal {
+		/// Packs rectangles with the algorithm matching the configuration type
+		template<typename It, typename ItEnd>
+		Result pack(const ExactConfiguration& config, It begin, ItEnd end, std::size_t size) {
+			return packExact(config, begin, end, size);
+		}
+	}
+	/// \endcond
+
+	/**
+	 * @}
+	 */
+}
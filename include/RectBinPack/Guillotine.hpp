@@ -8,6 +8,10 @@
 #include "RectBinPack.hpp"
 
 #include <algorithm>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace RectBinPack {
@@ -46,10 +50,183 @@ namespace RectBinPack {
 		bool merge; ///< Enables merging. Free spaces that can be represented by a bigger one are merged.
 		GuillotineRectHeuristic rectHeuristic; ///< Heuristic to use for finding a free space
 		GuillotineSplitHeuristic splitHeuristic; ///< Heuristic to use for splitting the free space
+		unsigned int borderPadding; ///< Space between the rectangles and the edges of the bin
+		unsigned int spacing; ///< Space between two rectangles
+		unsigned int alignment; ///< Positions and occupied sizes are multiples of it. Defaults to 1 if 0
+		std::vector<Rect> obstacles; ///< Regions which are blocked in every bin, in bin coordinates
+		BinSelection binSelection; ///< Policy for choosing the open bin
+
+		/**
+		 * \brief Packs the rectangles in the given order instead of the best fitting one first
+		 *
+		 * Every rectangle only looks for its best free rectangle, which is much faster. Sort the rectangles
+		 * beforehand, e.g. by decreasing area. With GuillotineRectHeuristic::BestAreaFit the free rectangles are kept
+		 * ordered by area, so the smallest one which fits is found without scanning all of them.
+		 */
+		bool sequential;
+
+		/**
+		 * \brief Stops packing as soon as the rectangles left can't fit into the last bin anymore
+		 *
+		 * Once the maximum number of bins is open, the area and the size of the rectangles left are compared with
+		 * the free space before every placement. Saves time if packing is going to fail, but all rectangles which
+		 * weren't placed yet are set to InvalidBin, even those which would still have fit.
+		 */
+		bool stopEarly;
 	};
 
 	/// \cond INTERNAL
 	namespace Internal {
+		/// Bin of the %Guillotine algorithm
+		struct GuillotineBin {
+			std::vector<Rect> freeRects;
+			unsigned int maxWidth = 0; // Largest width of all free rectangles
+			unsigned int maxHeight = 0; // Largest height of all free rectangles
+			unsigned int maxArea = 0; // Largest area of all free rectangles
+
+			// Free rectangles which are too small for the rectangles left. Only used without merging, since parked
+			// rectangles can't be merged with their neighbors.
+			std::vector<Rect> parkedRects;
+
+			// Indices of the free rectangles by their corners. Only maintained if merging is enabled. Free
+			// rectangles never overlap, so every corner belongs to at most one of them.
+			std::unordered_map<std::uint64_t, std::size_t> topLeft;
+			std::unordered_map<std::uint64_t, std::size_t> topRight;
+			std::unordered_map<std::uint64_t, std::size_t> bottomLeft;
+
+			// Indices of the free rectangles by their size, so perfect fits are found without scanning
+			std::unordered_multimap<std::uint64_t, std::size_t> sizes;
+
+			// Indices of the free rectangles ordered by their area. Only maintained if usesAreaIndex is true.
+			std::set<std::pair<std::uint64_t, std::size_t>> areas;
+
+			/// Checks if the configuration needs the free rectangles ordered by area
+			static bool usesAreaIndex(const GuillotineConfiguration& config) {
+				return config.sequential && config.rectHeuristic == GuillotineRectHeuristic::BestAreaFit;
+			}
+
+			/// Returns the key of a corner
+			static std::uint64_t pointKey(unsigned int x, unsigned int y) {
+				return ((std::uint64_t) x << 32) | y;
+			}
+
+			/// Returns the key of a size
+			static std::uint64_t sizeKey(unsigned int width, unsigned int height) {
+				return ((std::uint64_t) width << 32) | height;
+			}
+
+			/// Adds the corners of the free rectangle at \p i to the indices
+			void index(std::size_t i) {
+				const auto& rect = freeRects[i];
+
+				topLeft[pointKey(rect.left(), rect.top())] = i;
+				topRight[pointKey(rect.right(), rect.top())] = i;
+				bottomLeft[pointKey(rect.left(), rect.bottom())] = i;
+			}
+
+			/// Removes the corners of the free rectangle at \p i from the indices
+			void unindex(std::size_t i) {
+				const auto& rect = freeRects[i];
+
+				topLeft.erase(pointKey(rect.left(), rect.top()));
+				topRight.erase(pointKey(rect.right(), rect.top()));
+				bottomLeft.erase(pointKey(rect.left(), rect.bottom()));
+			}
+
+			/// Adds the size of the free rectangle at \p i to the index
+			void indexSize(std::size_t i) {
+				sizes.emplace(sizeKey(freeRects[i].width, freeRects[i].height), i);
+			}
+
+			/// Removes the size of the free rectangle at \p i from the index
+			void unindexSize(std::size_t i) {
+				const auto range = sizes.equal_range(sizeKey(freeRects[i].width, freeRects[i].height));
+
+				for (auto it = range.first; it != range.second; ++it) {
+					if (it->second == i) {
+						sizes.erase(it);
+						return;
+					}
+				}
+			}
+
+			/// Adds the area of the free rectangle at \p i to the index
+			void indexArea(std::size_t i) {
+				areas.emplace((std::uint64_t) freeRects[i].width * freeRects[i].height, i);
+			}
+
+			/// Removes the area of the free rectangle at \p i from the index
+			void unindexArea(std::size_t i) {
+				areas.erase(std::make_pair((std::uint64_t) freeRects[i].width * freeRects[i].height, i));
+			}
+
+			/**
+			 * \brief Looks up a free rectangle with the given size
+			 *
+			 * \returns true, if one was found. Its index is written to \p out.
+			 */
+			bool findSize(unsigned int width, unsigned int height, std::size_t& out) const {
+				const auto it = sizes.find(sizeKey(width, height));
+
+				if (it == sizes.end())
+					return false;
+
+				out = it->second;
+				return true;
+			}
+
+			/// Returns the approximate number of bytes allocated by the bin
+			std::size_t memoryUsage() const {
+				const auto nodeSize = sizeof(std::pair<const std::uint64_t, std::size_t>) + sizeof(void*);
+				const auto nodes = topLeft.size() + topRight.size() + bottomLeft.size() + sizes.size();
+				const auto buckets = topLeft.bucket_count() + topRight.bucket_count() + bottomLeft.bucket_count() + sizes.bucket_count();
+
+				const auto areaNodeSize = sizeof(std::pair<std::uint64_t, std::size_t>) + 4 * sizeof(void*);
+
+				return (freeRects.capacity() + parkedRects.capacity()) * sizeof(Rect) + nodes * nodeSize +
+					buckets * sizeof(void*) + areas.size() * areaNodeSize;
+			}
+
+			/// Recalculates the bounds of the free rectangles
+			void updateBounds() {
+				maxWidth = 0;
+				maxHeight = 0;
+				maxArea = 0;
+
+				for (auto& freeRect : freeRects) {
+					maxWidth = std::max(maxWidth, freeRect.width);
+					maxHeight = std::max(maxHeight, freeRect.height);
+					maxArea = std::max(maxArea, freeRect.width * freeRect.height);
+				}
+			}
+
+			/// Rebuilds the indices of all free rectangles which are needed by \p config
+			void reindex(const GuillotineConfiguration& config) {
+				topLeft.clear();
+				topRight.clear();
+				bottomLeft.clear();
+				sizes.clear();
+				areas.clear();
+
+				for (std::size_t i = 0; i < freeRects.size(); ++i) {
+					indexSize(i);
+
+					// The corner indices are only maintained with merging
+					if (config.merge)
+						index(i);
+
+					if (usesAreaIndex(config))
+						indexArea(i);
+				}
+			}
+		};
+
+		/// Bins of the %Guillotine algorithm, which can be packed into again later
+		struct GuillotineState {
+			std::vector<GuillotineBin> bins; ///< All bins. Closed bins have no free rectangles.
+			std::uint64_t freeArea; ///< Area left in the open bins
+		};
+
 		/// Implementation of the %Guillotine algorithm
 		template<typename It>
 		class Guillotine {
@@ -70,19 +247,30 @@ namespace RectBinPack {
 			 */
 			template<typename ItEnd>
 			Guillotine(It begin, ItEnd end, std::size_t size, const GuillotineConfiguration& config):
-				m_config(config) {
+				m_config(config), m_layout(config.width, config.height, config.borderPadding, config.spacing, config.alignment) {
 
+				initEmptyBin();
 				m_rects.reserve(size);
 
 				for (auto it = begin; it != end; ++it) {
-					const auto rect = toRect(*it);
+					const auto original = toRect(*it);
+					const auto rect = m_layout.inflate(original);
 
-					if (rect.width > config.width || rect.height > config.height)
-						if (!config.canFlip || (rect.height > config.width || rect.width > config.height))
+					if (rect.width > m_layout.width() || rect.height > m_layout.height())
+						if (!config.canFlip || (rect.height > m_layout.width() || rect.width > m_layout.height()))
 							throw RectangleTooLargeError("rectangle is too large");
 			
-					if (rect.width > 0 && rect.height > 0)
-						m_rects.push_back(it);
+					if (original.width > 0 && original.height > 0) {
+						if (!fitsEmptyBin(rect))
+							throw RectangleTooLargeError("rectangle doesn't fit next to the obstacles");
+
+						const auto group = m_rects.add(it, rect);
+
+						if (config.sequential)
+							m_sequence.push_back(group);
+
+						m_pendingArea += (std::uint64_t) rect.width * rect.height;
+					}
 					else
 						fromBinRect(*it, { { 0, 0, 0, 0 }, InvalidBin, false });
 				}
@@ -94,93 +282,225 @@ namespace RectBinPack {
 			 * \returns true, if packing succeeded
 			 */
 			bool pack() {
-				m_bins = std::vector<Bin> {
-					(unsigned int) std::max(1, m_config.minBins),
-					Bin { std::vector<Rect> { Rect { 0, 0, m_config.width, m_config.height } } }
-				};
+				m_memory = 0;
+
+				for (auto& bin : m_bins)
+					m_memory += bin.memoryUsage();
+
+				// Neither the groups nor the sequence grow while packing
+				m_rectsMemory = m_rects.memoryUsage() + m_sequence.capacity() * sizeof(std::size_t);
+				m_peakMemory = m_memory + m_bins.capacity() * sizeof(Bin) + m_rectsMemory;
+
+				if (m_bins.empty()) {
+					m_freeArea = 0;
+
+					for (auto i = 0; i < std::max(1, m_config.minBins); ++i)
+						addBin();
+				}
 
 				while (!m_rects.empty()) {
 					FindResult findResult;
 
+					// Stop early if the outcome is already known
+					if (m_config.stopEarly && isLastBin() && cannotFit())
+						return fail();
+
 					if (!findBest(findResult)) {
-						if (m_config.maxBins > 0 && m_bins.size() >= (unsigned int) m_config.maxBins) {
-							for (auto& rect : m_rects)
-								fromBinRect(*rect, {
-									toRect(*rect),
-									InvalidBin,
-									false
-								});
-							
-							return false;
-						}
+						if (isLastBin())
+							return fail();
 
 						for (auto& bin : m_bins)
-							bin.freeRects.clear();
+							closeBin(bin);
 
-						m_bins.push_back({ std::vector<Rect> { Rect { 0, 0, m_config.width, m_config.height } } });
+						m_freeArea = 0;
+						addBin();
 						continue;
 					}
 
 					const auto binIndex = std::distance(m_bins.begin(), findResult.bin);
 					const auto& occupiedRect = findResult.occupiedRect;
+					const auto it = m_rects.take(findResult.group);
+
+					if (m_config.sequential)
+						++m_sequenceNext;
 
-					fromBinRect(**findResult.rect, {
-						occupiedRect,
+					fromBinRect(*it, {
+						m_layout.place(occupiedRect, toRect(*it), findResult.flip),
 						(unsigned int) binIndex,
 						findResult.flip
 					});
 
-					auto& freeRect = findResult.freeRect;
-					auto& bin = findResult.bin;
+					auto& bin = *findResult.bin;
+					const auto memory = bin.memoryUsage();
+					const auto freeRectIndex = (std::size_t) std::distance(bin.freeRects.begin(), findResult.freeRect);
+					const auto freeRect = *findResult.freeRect;
 
 					// Split free rectangle
-					if (occupiedRect.width != freeRect->width || occupiedRect.height != freeRect->height) {
-						if (occupiedRect.width == freeRect->width) {
-							freeRect->y += occupiedRect.height;
-							freeRect->height -= occupiedRect.height;
+					if (occupiedRect.width != freeRect.width || occupiedRect.height != freeRect.height) {
+						if (occupiedRect.width == freeRect.width) {
+							setFreeRect(bin, freeRectIndex, {
+								freeRect.x, freeRect.y + occupiedRect.height, freeRect.width, freeRect.height - occupiedRect.height
+							});
+
+							if (m_config.merge)
+								merge(bin, freeRectIndex);
 						}
-						else if (occupiedRect.height == freeRect->height) {
-							freeRect->x += occupiedRect.width;
-							freeRect->width -= occupiedRect.width;
+						else if (occupiedRect.height == freeRect.height) {
+							setFreeRect(bin, freeRectIndex, {
+								freeRect.x + occupiedRect.width, freeRect.y, freeRect.width - occupiedRect.width, freeRect.height
+							});
+
+							if (m_config.merge)
+								merge(bin, freeRectIndex);
 						}
 						else {
 							Rect bottom, right;
 
-							split(*freeRect, occupiedRect.width, occupiedRect.height, bottom, right);
-							
-							*freeRect = bottom;
-							bin->freeRects.push_back(right);
-						}
+							split(freeRect, occupiedRect.width, occupiedRect.height, bottom, right);
 
-						if (m_config.merge)
-							merge(bin->freeRects);
+							setFreeRect(bin, freeRectIndex, bottom);
+							addFreeRect(bin, right);
+
+							if (m_config.merge) {
+								merge(bin, freeRectIndex);
+
+								// The right part is either untouched or was merged into the bottom part
+								const auto it = bin.topLeft.find(Bin::pointKey(right.x, right.y));
+
+								if (it != bin.topLeft.end() && bin.freeRects[it->second] == right)
+									merge(bin, it->second);
+							}
+						}
 					}
 					else
-						swapAndPop(bin->freeRects, freeRect);
+						removeFreeRect(bin, freeRectIndex);
+
+					// The area index already skips the free rectangles which are too small, so nothing is parked. Its
+					// bounds are kept up to date by indexFreeRect instead of scanning all free rectangles.
+					if (m_areaIndex)
+						bin.maxArea = bin.areas.empty() ? 0 : (unsigned int) bin.areas.rbegin()->first;
+					else {
+						if (!m_config.merge)
+							parkFreeRects(bin);
+
+						bin.updateBounds();
+					}
 
-					// Remove rect
-					swapAndPop(m_rects, findResult.rect);
+					trackMemory(memory, bin.memoryUsage());
+					m_pendingArea -= (std::uint64_t) occupiedRect.width * occupiedRect.height;
+					m_freeArea -= (std::uint64_t) occupiedRect.width * occupiedRect.height;
 				}
 
 				return true;
 			}
 
+			/**
+			 * \brief Packs the rectangles into the bins of \p state
+			 *
+			 * Bins are only added if needed. The bins are stored in \p state afterwards. Parked free rectangles are
+			 * restored, so smaller rectangles can be packed into them later.
+			 *
+			 * \returns true, if packing succeeded
+			 */
+			bool pack(GuillotineState& state) {
+				m_bins.swap(state.bins);
+				m_freeArea = state.freeArea;
+
+				const auto result = pack();
+
+				for (auto& bin : m_bins) {
+					for (auto& parkedRect : bin.parkedRects)
+						addFreeRect(bin, parkedRect);
+
+					bin.parkedRects.clear();
+					bin.updateBounds();
+				}
+
+				m_bins.swap(state.bins);
+				state.freeArea = m_freeArea;
+				return result;
+			}
+
+			/**
+			 * \brief Occupies space in a bin of \p state before packing, so nothing else is placed there
+			 *
+			 * Bins are added until the bin exists and the minimum number of bins is reached. The space may cover
+			 * several free rectangles.
+			 *
+			 * \param state Bins to modify
+			 * \param binIndex Index of the bin
+			 * \param occupiedRect Space inside the packing area of the bin
+			 * \returns false, if the space isn't free
+			 */
+			bool occupy(GuillotineState& state, unsigned int binIndex, const Rect& occupiedRect) {
+				m_bins.swap(state.bins);
+				m_freeArea = state.freeArea;
+
+				if (m_bins.empty())
+					m_freeArea = 0;
+
+				while (m_bins.size() < (unsigned int) std::max(1, m_config.minBins))
+					addBin();
+
+				// Bins which don't exist yet are checked against an empty bin, so they are only added if needed
+				const auto& target = binIndex < m_bins.size() ? m_bins[binIndex] : m_emptyBin;
+				std::uint64_t coveredArea = 0;
+
+				// Free rectangles never overlap, so the space is free if they cover its whole area
+				for (auto& freeRect : target.freeRects) {
+					if (!occupiedRect.intersect(freeRect))
+						continue;
+
+					const auto width = std::min(occupiedRect.right(), freeRect.right()) - std::max(occupiedRect.left(), freeRect.left());
+					const auto height = std::min(occupiedRect.bottom(), freeRect.bottom()) - std::max(occupiedRect.top(), freeRect.top());
+
+					coveredArea += (std::uint64_t) width * height;
+				}
+
+				const auto isFree = coveredArea == (std::uint64_t) occupiedRect.width * occupiedRect.height;
+
+				if (isFree) {
+					while (m_bins.size() <= binIndex)
+						addBin();
+
+					subtract(m_bins[binIndex], occupiedRect);
+					m_freeArea -= (std::uint64_t) occupiedRect.width * occupiedRect.height;
+				}
+
+				m_bins.swap(state.bins);
+				state.freeArea = m_freeArea;
+				return isFree;
+			}
+
 			/// Returns the number of bins used
 			unsigned int numBins() const {
 				return m_bins.size();
 			}
 
+			/// Returns the approximate peak number of bytes used during the last call to pack
+			std::size_t peakMemory() const {
+				return m_peakMemory;
+			}
+
+			/// Checks if a rectangle of the size of \p rect fits into an empty bin next to the obstacles
+			bool fits(const Rect& rect) const {
+				const auto size = m_layout.inflate(rect);
+
+				if (size.width > m_layout.width() || size.height > m_layout.height())
+					if (!m_config.canFlip || (size.height > m_layout.width() || size.width > m_layout.height()))
+						return false;
+
+				return fitsEmptyBin(size);
+			}
+
 		private:
-			struct Bin {
-				std::vector<Rect> freeRects;
-			};
+			using Bin = GuillotineBin;
 
-			using RectIt = typename std::vector<It>::iterator;
 			using BinIt = typename std::vector<Bin>::iterator;
 			using FreeRectIt = typename std::vector<Rect>::iterator;
 
 			struct FindResult {
-				RectIt rect;
+				std::size_t group;
 				Rect occupiedRect;
 				BinIt bin;
 				FreeRectIt freeRect;
@@ -239,36 +559,81 @@ namespace RectBinPack {
 				outRight = { freeRect.x + width, freeRect.y, freeRect.width - width, splitHor ? height : freeRect.height };
 			}
 
+			// Smallest sizes of the rectangles which are left for packing
+			struct Bounds {
+				unsigned int minWidth;
+				unsigned int minHeight;
+				unsigned int minArea;
+			};
+
+			Bounds getBounds() {
+				const auto invalid = std::numeric_limits<unsigned int>::max();
+				Bounds bounds { invalid, invalid, invalid };
+
+				for (auto group : m_rects.active()) {
+					const auto& rect = m_rects[group].size;
+
+					bounds.minWidth = std::min(bounds.minWidth, m_config.canFlip ? std::min(rect.width, rect.height) : rect.width);
+					bounds.minHeight = std::min(bounds.minHeight, m_config.canFlip ? std::min(rect.width, rect.height) : rect.height);
+					bounds.minArea = std::min(bounds.minArea, rect.width * rect.height);
+				}
+
+				return bounds;
+			}
+
+			/**
+			 * Checks if none of the rectangles left fit into free space with the given largest width, height and area.
+			 * A flipped rectangle only fits if its shorter side fits into the shorter side of the free space.
+			 */
+			bool cannotFitInto(const Bounds& bounds, unsigned int width, unsigned int height, unsigned int area) const {
+				if (bounds.minArea > area)
+					return true;
+
+				if (m_config.canFlip)
+					return bounds.minWidth > std::min(width, height);
+
+				return bounds.minWidth > width || bounds.minHeight > height;
+			}
+
 			bool findBest(FindResult& result) {
+				if (m_config.sequential)
+					return findNext(result);
+
 				const auto invalidScore = std::numeric_limits<unsigned int>::max();
+				const auto bounds = getBounds();
 				auto bestScore = invalidScore;
 
-				for (auto binIt = m_bins.begin(); binIt != m_bins.end(); ++binIt) {
+				for (auto binIndex : getBinOrder(m_config.binSelection, m_bins)) {
+					const auto binIt = m_bins.begin() + binIndex;
 					auto& bin = *binIt;
 
+					// Only the global best placement needs the other bins once a placement was found
+					if (m_config.binSelection != BinSelection::GlobalBest && bestScore != invalidScore)
+						break;
+
+					// Skip bins where none of the rectangles fit
+					if (bin.freeRects.empty() || cannotFitInto(bounds, bin.maxWidth, bin.maxHeight, bin.maxArea))
+						continue;
+
+					// A perfect fit is taken right away, so the scores don't need to be calculated
+					if (findPerfectFit(binIt, result))
+						return true;
+
 					for (auto freeRectIt = bin.freeRects.begin(); freeRectIt != bin.freeRects.end(); ++freeRectIt) {
 						auto& freeRect = *freeRectIt;
 
-						for (auto rectIt = m_rects.begin(); rectIt != m_rects.end(); ++rectIt) {
-							const auto rect = toRect(**rectIt);
+						if (cannotFitInto(bounds, freeRect.width, freeRect.height, freeRect.width * freeRect.height))
+							continue;
 
-							// Check if rect fits perfectly in freeRect
-							if (rect.width == freeRect.width && rect.height == freeRect.height) {
-								result = { rectIt, freeRect, binIt, freeRectIt, false };
-								return true;
-							}
+						// Rectangles of the same size get the same score, so only the first one of every group is tried
+						for (auto group : m_rects.active()) {
+							const auto& rect = m_rects[group].size;
 
-							if (m_config.canFlip && rect.height == freeRect.width && rect.width == freeRect.height) {
-								result = { rectIt, freeRect, binIt, freeRectIt, true };
-								return true;
-							}
-
-							// Otherwise calculate score
 							if (rect.width <= freeRect.width && rect.height <= freeRect.height) {
 								const auto score = getScore(freeRect, rect.width, rect.height);
 
 								if (score < bestScore) {
-									result = { rectIt, {}, binIt, freeRectIt, false };
+									result = { group, {}, binIt, freeRectIt, false };
 									bestScore = score;
 								}
 							}
@@ -277,7 +642,7 @@ namespace RectBinPack {
 								const auto score = getScore(freeRect, rect.height, rect.width);
 
 								if (score < bestScore) {
-									result = { rectIt, {}, binIt, freeRectIt, true };
+									result = { group, {}, binIt, freeRectIt, true };
 									bestScore = score;
 								}
 							}
@@ -285,54 +650,440 @@ namespace RectBinPack {
 					}
 				}
 
-				if (bestScore != invalidScore) {
-					const auto rect = toRect(**result.rect);
-
-					const Rect occupiedRect {
-						result.freeRect->x,
-						result.freeRect->y,
-						rect.width,
-						rect.height
-					};
-
-					result.occupiedRect = result.flip ? occupiedRect.flipped() : occupiedRect;
-				}
+				if (bestScore != invalidScore)
+					setOccupiedRect(result);
 
 				return bestScore != invalidScore;
 			}
 
-			void merge(std::vector<Rect>& freeRects) {
-				for (auto i = freeRects.begin(); i != freeRects.end(); ++i) {
-					for (auto j = std::next(i); j != freeRects.end(); ++j) {
-						if (i->x == j->x && i->width == j->width) {
-							if (i->bottom() == j->y) {
-								i->height += j->height;
-								swapAndPop(freeRects, j--);
-							}
-							else if (j->bottom() == i->y) {
-								i->y -= j->height;
-								i->height += j->height;
-								swapAndPop(freeRects, j--);
+			/**
+			 * Finds the best free rectangle for the next rectangle in input order. With the area index the free
+			 * rectangles are visited from the smallest area which can hold the rectangle upwards, so the first one it
+			 * fits into is the best one.
+			 */
+			bool findNext(FindResult& result) {
+				const auto invalidScore = std::numeric_limits<unsigned int>::max();
+				const auto group = m_sequence[m_sequenceNext];
+				const auto& rect = m_rects[group].size;
+				const auto area = rect.width * rect.height;
+				const auto shortSide = std::min(rect.width, rect.height);
+				auto bestScore = invalidScore;
+
+				const Bounds bounds {
+					m_config.canFlip ? shortSide : rect.width, m_config.canFlip ? shortSide : rect.height, area
+				};
+
+				for (auto binIndex : getBinOrder(m_config.binSelection, m_bins)) {
+					const auto binIt = m_bins.begin() + binIndex;
+					auto& bin = *binIt;
+					std::size_t index;
+
+					if (m_config.binSelection != BinSelection::GlobalBest && bestScore != invalidScore)
+						break;
+
+					if (bin.freeRects.empty() || cannotFitInto(bounds, bin.maxWidth, bin.maxHeight, bin.maxArea))
+						continue;
+
+					if (bin.findSize(rect.width, rect.height, index)) {
+						result = { group, bin.freeRects[index], binIt, bin.freeRects.begin() + index, false };
+						return true;
+					}
+
+					if (m_config.canFlip && bin.findSize(rect.height, rect.width, index)) {
+						result = { group, bin.freeRects[index], binIt, bin.freeRects.begin() + index, true };
+						return true;
+					}
+
+					if (m_areaIndex) {
+						for (auto it = bin.areas.lower_bound(std::make_pair((std::uint64_t) area, std::size_t(0))); it != bin.areas.end(); ++it) {
+							const auto& freeRect = bin.freeRects[it->second];
+							const auto fits = rect.width <= freeRect.width && rect.height <= freeRect.height;
+
+							if (!fits && !(m_config.canFlip && rect.height <= freeRect.width && rect.width <= freeRect.height))
+								continue;
+
+							const auto score = (unsigned int) it->first - area;
+
+							if (score < bestScore) {
+								result = { group, {}, binIt, bin.freeRects.begin() + it->second, !fits };
+								bestScore = score;
 							}
+
+							break;
 						}
-						else if (i->y == j->y && i->height == j->height) {
-							if (i->right() == j->x) {
-								i->width += j->width;
-								swapAndPop(freeRects, j--);
+
+						continue;
+					}
+
+					for (auto freeRectIt = bin.freeRects.begin(); freeRectIt != bin.freeRects.end(); ++freeRectIt) {
+						const auto& freeRect = *freeRectIt;
+
+						if (rect.width <= freeRect.width && rect.height <= freeRect.height) {
+							const auto score = getScore(freeRect, rect.width, rect.height);
+
+							if (score < bestScore) {
+								result = { group, {}, binIt, freeRectIt, false };
+								bestScore = score;
 							}
-							else if (j->right() == i->x) {
-								i->x -= j->width;
-								i->width += j->width;
-								swapAndPop(freeRects, j--);
+						}
+
+						if (m_config.canFlip && rect.height <= freeRect.width && rect.width <= freeRect.height) {
+							const auto score = getScore(freeRect, rect.height, rect.width);
+
+							if (score < bestScore) {
+								result = { group, {}, binIt, freeRectIt, true };
+								bestScore = score;
 							}
 						}
 					}
 				}
+
+				if (bestScore != invalidScore)
+					setOccupiedRect(result);
+
+				return bestScore != invalidScore;
+			}
+
+			/// Sets the space the rectangle of \p result takes up at the top left corner of its free rectangle
+			void setOccupiedRect(FindResult& result) {
+				const auto& rect = m_rects[result.group].size;
+
+				const Rect occupiedRect {
+					result.freeRect->x,
+					result.freeRect->y,
+					rect.width,
+					rect.height
+				};
+
+				result.occupiedRect = result.flip ? occupiedRect.flipped() : occupiedRect;
+			}
+
+			/**
+			 * Looks for a free rectangle of the bin with exactly the size of one of the rectangles left, flipped if
+			 * allowed. Both are indexed by size, so the smaller of the two sets is iterated and looked up in the other.
+			 */
+			bool findPerfectFit(BinIt binIt, FindResult& result) {
+				auto& bin = *binIt;
+				std::size_t group, index;
+
+				if (bin.freeRects.size() < m_rects.active().size()) {
+					for (auto freeRectIt = bin.freeRects.begin(); freeRectIt != bin.freeRects.end(); ++freeRectIt) {
+						const auto& freeRect = *freeRectIt;
+
+						if (m_rects.find(freeRect.width, freeRect.height, group)) {
+							result = { group, freeRect, binIt, freeRectIt, false };
+							return true;
+						}
+
+						if (m_config.canFlip && m_rects.find(freeRect.height, freeRect.width, group)) {
+							result = { group, freeRect, binIt, freeRectIt, true };
+							return true;
+						}
+					}
+				}
+				else {
+					for (auto group : m_rects.active()) {
+						const auto& rect = m_rects[group].size;
+
+						if (bin.findSize(rect.width, rect.height, index)) {
+							result = { group, bin.freeRects[index], binIt, bin.freeRects.begin() + index, false };
+							return true;
+						}
+
+						if (m_config.canFlip && bin.findSize(rect.height, rect.width, index)) {
+							result = { group, bin.freeRects[index], binIt, bin.freeRects.begin() + index, true };
+							return true;
+						}
+					}
+				}
+
+				return false;
+			}
+
+			/// Creates the bin every new bin is copied from. The obstacles are removed from its free space.
+			void initEmptyBin() {
+				addFreeRect(m_emptyBin, { 0, 0, m_layout.width(), m_layout.height() });
+
+				std::vector<Rect> blocked;
+
+				for (auto& obstacle : m_config.obstacles) {
+					Rect rect;
+
+					if (m_layout.block(obstacle, rect)) {
+						subtract(m_emptyBin, rect);
+						blocked.push_back(rect);
+					}
+				}
+
+				m_emptyBin.updateBounds();
+				m_emptyArea = (std::uint64_t) m_layout.width() * m_layout.height() - getUnionArea(blocked);
+			}
+
+			/// Checks if the space fits into an empty bin
+			bool fitsEmptyBin(const Rect& rect) const {
+				return std::any_of(m_emptyBin.freeRects.begin(), m_emptyBin.freeRects.end(), [&](const Rect& freeRect) {
+					return (rect.width <= freeRect.width && rect.height <= freeRect.height) ||
+						(m_config.canFlip && rect.height <= freeRect.width && rect.width <= freeRect.height);
+				});
+			}
+
+			void addBin() {
+				m_bins.push_back(m_emptyBin);
+				m_freeArea += m_emptyArea;
+				trackMemory(0, m_bins.back().memoryUsage());
+			}
+
+			/// Updates the memory used by the bins after a bin changed from \p before to \p after bytes
+			void trackMemory(std::size_t before, std::size_t after) {
+				m_memory = m_memory - before + after;
+				m_peakMemory = std::max(m_peakMemory, m_memory + m_bins.capacity() * sizeof(Bin) + m_rectsMemory);
+			}
+
+			/**
+			 * Removes \p rect from the free rectangles of the bin. Every free rectangle it intersects is split into up
+			 * to four parts, either full width strips above and below it or full height strips left and right of it.
+			 * The split which keeps the larger part is used.
+			 */
+			void subtract(Bin& bin, const Rect& rect) {
+				std::vector<Rect> covered;
+
+				for (auto& freeRect : bin.freeRects)
+					if (rect.intersect(freeRect))
+						covered.push_back(freeRect);
+
+				for (auto& freeRect : covered) {
+					const auto it = std::find(bin.freeRects.begin(), bin.freeRects.end(), freeRect);
+					removeFreeRect(bin, (std::size_t) std::distance(bin.freeRects.begin(), it));
+				}
+
+				for (auto& freeRect : covered) {
+					const auto top = std::max(rect.top(), freeRect.top());
+					const auto bottom = std::min(rect.bottom(), freeRect.bottom());
+					const auto left = std::max(rect.left(), freeRect.left());
+					const auto right = std::min(rect.right(), freeRect.right());
+
+					const Rect horizontal[] {
+						{ freeRect.x, freeRect.y, freeRect.width, top - freeRect.top() },
+						{ freeRect.x, bottom, freeRect.width, freeRect.bottom() - bottom },
+						{ freeRect.x, top, left - freeRect.left(), bottom - top },
+						{ right, top, freeRect.right() - right, bottom - top }
+					};
+
+					const Rect vertical[] {
+						{ freeRect.x, freeRect.y, left - freeRect.left(), freeRect.height },
+						{ right, freeRect.y, freeRect.right() - right, freeRect.height },
+						{ left, freeRect.y, right - left, top - freeRect.top() },
+						{ left, bottom, right - left, freeRect.bottom() - bottom }
+					};
+
+					const auto largest = [](const Rect (&parts)[4]) {
+						std::uint64_t area = 0;
+
+						for (auto& part : parts)
+							area = std::max(area, (std::uint64_t) part.width * part.height);
+
+						return area;
+					};
+
+					for (auto& part : largest(vertical) > largest(horizontal) ? vertical : horizontal) {
+						if (part.width == 0 || part.height == 0)
+							continue;
+
+						addFreeRect(bin, part);
+
+						if (m_config.merge)
+							merge(bin, bin.freeRects.size() - 1);
+					}
+				}
+
+				bin.updateBounds();
+			}
+
+			/// Checks if no more bins can be added
+			bool isLastBin() const {
+				return m_config.maxBins > 0 && m_bins.size() >= (unsigned int) m_config.maxBins;
+			}
+
+			/// Sets the rectangles which are left to InvalidBin
+			bool fail() {
+				m_rects.forEach([](It rect) {
+					fromBinRect(*rect, {
+						toRect(*rect),
+						InvalidBin,
+						false
+					});
+				});
+
+				return false;
+			}
+
+			/**
+			 * Checks if the rectangles left can't be packed into the free space. Without merging free rectangles
+			 * only shrink, so a rectangle which doesn't fit into the largest free width and height never will.
+			 */
+			bool cannotFit() {
+				if (m_pendingArea > m_freeArea)
+					return true;
+
+				if (m_config.merge)
+					return false;
+
+				auto maxWidth = 0u, maxHeight = 0u;
+
+				for (auto& bin : m_bins) {
+					maxWidth = std::max(maxWidth, bin.maxWidth);
+					maxHeight = std::max(maxHeight, bin.maxHeight);
+				}
+
+				for (auto group : m_rects.active()) {
+					const auto& rect = m_rects[group].size;
+
+					if (rect.width > maxWidth || rect.height > maxHeight)
+						if (!m_config.canFlip || rect.height > maxWidth || rect.width > maxHeight)
+							return true;
+				}
+
+				return false;
+			}
+
+			/// Adds the free rectangle at \p i to the indices the configuration needs
+			void indexFreeRect(Bin& bin, std::size_t i) {
+				bin.indexSize(i);
+
+				if (m_config.merge)
+					bin.index(i);
+
+				if (m_areaIndex) {
+					bin.indexArea(i);
+
+					// The largest width and height only grow here, so they stay upper bounds
+					bin.maxWidth = std::max(bin.maxWidth, bin.freeRects[i].width);
+					bin.maxHeight = std::max(bin.maxHeight, bin.freeRects[i].height);
+				}
+			}
+
+			/// Removes the free rectangle at \p i from the indices the configuration needs
+			void unindexFreeRect(Bin& bin, std::size_t i) {
+				bin.unindexSize(i);
+
+				if (m_config.merge)
+					bin.unindex(i);
+
+				if (m_areaIndex)
+					bin.unindexArea(i);
+			}
+
+			void addFreeRect(Bin& bin, const Rect& rect) {
+				bin.freeRects.push_back(rect);
+				indexFreeRect(bin, bin.freeRects.size() - 1);
+			}
+
+			void setFreeRect(Bin& bin, std::size_t i, const Rect& rect) {
+				unindexFreeRect(bin, i);
+				bin.freeRects[i] = rect;
+				indexFreeRect(bin, i);
+			}
+
+			void removeFreeRect(Bin& bin, std::size_t i) {
+				const auto last = bin.freeRects.size() - 1;
+
+				unindexFreeRect(bin, i);
+
+				if (i != last) {
+					unindexFreeRect(bin, last);
+					bin.freeRects[i] = bin.freeRects[last];
+					indexFreeRect(bin, i);
+				}
+
+				bin.freeRects.pop_back();
+			}
+
+			/// Moves the free rectangles where none of the rectangles left fit out of the way
+			void parkFreeRects(Bin& bin) {
+				const auto bounds = getBounds();
+
+				for (std::size_t i = 0; i < bin.freeRects.size();) {
+					const auto& freeRect = bin.freeRects[i];
+
+					if (cannotFitInto(bounds, freeRect.width, freeRect.height, freeRect.width * freeRect.height)) {
+						bin.parkedRects.push_back(freeRect);
+						removeFreeRect(bin, i);
+					}
+					else
+						++i;
+				}
+			}
+
+			/// Releases the storage of a bin which is never packed into again
+			void closeBin(Bin& bin) {
+				const auto memory = bin.memoryUsage();
+
+				std::vector<Rect>().swap(bin.freeRects);
+				std::vector<Rect>().swap(bin.parkedRects);
+				decltype(bin.topLeft)().swap(bin.topLeft);
+				decltype(bin.topRight)().swap(bin.topRight);
+				decltype(bin.bottomLeft)().swap(bin.bottomLeft);
+				decltype(bin.sizes)().swap(bin.sizes);
+				decltype(bin.areas)().swap(bin.areas);
+				bin.updateBounds();
+
+				trackMemory(memory, 0);
+			}
+
+			static bool findNeighbor(const std::unordered_map<std::uint64_t, std::size_t>& map, unsigned int x, unsigned int y, std::size_t& out) {
+				const auto it = map.find(Bin::pointKey(x, y));
+
+				if (it == map.end())
+					return false;
+
+				out = it->second;
+				return true;
+			}
+
+			/**
+			 * Merges the free rectangle at \p i with its neighbors until no neighbor shares a full edge with it anymore.
+			 * Only the neighbors of the rectangle are looked up, so this has to be called for every modified rectangle.
+			 */
+			void merge(Bin& bin, std::size_t i) {
+				for (;;) {
+					const auto rect = bin.freeRects[i];
+					std::size_t other;
+					Rect merged;
+
+					if (findNeighbor(bin.topLeft, rect.left(), rect.bottom(), other) && bin.freeRects[other].width == rect.width)
+						merged = { rect.x, rect.y, rect.width, rect.height + bin.freeRects[other].height };
+					else if (findNeighbor(bin.bottomLeft, rect.left(), rect.top(), other) && bin.freeRects[other].width == rect.width)
+						merged = { rect.x, bin.freeRects[other].y, rect.width, rect.height + bin.freeRects[other].height };
+					else if (findNeighbor(bin.topLeft, rect.right(), rect.top(), other) && bin.freeRects[other].height == rect.height)
+						merged = { rect.x, rect.y, rect.width + bin.freeRects[other].width, rect.height };
+					else if (findNeighbor(bin.topRight, rect.left(), rect.top(), other) && bin.freeRects[other].height == rect.height)
+						merged = { bin.freeRects[other].x, rect.y, rect.width + bin.freeRects[other].width, rect.height };
+					else
+						return;
+
+					// Removing moves the last rectangle into the gap
+					if (i == bin.freeRects.size() - 1)
+						i = other;
+
+					removeFreeRect(bin, other);
+					setFreeRect(bin, i, merged);
+				}
 			}
 
 			const GuillotineConfiguration& m_config;
-			std::vector<It> m_rects;
+			const Layout m_layout;
+			RectGroups<It> m_rects;
 			std::vector<Bin> m_bins;
+			std::uint64_t m_pendingArea = 0; // Area of the rectangles left for packing
+			std::uint64_t m_freeArea = 0; // Area left in the open bins
+			Bin m_emptyBin;
+			std::uint64_t m_emptyArea = 0; // Free area of an empty bin
+			std::size_t m_memory = 0; // Memory used by the free rectangles and their indices in all bins
+			std::size_t m_rectsMemory = 0; // Memory used by the groups of rectangles and the sequence
+			std::size_t m_peakMemory = 0;
+			std::vector<std::size_t> m_sequence; // Groups of the rectangles in input order, only used in sequential mode
+			std::size_t m_sequenceNext = 0; // Position of the next rectangle in m_sequence
+			const bool m_areaIndex = Bin::usesAreaIndex(m_config);
 		};
 	}
 	/// \endcond
@@ -344,6 +1095,10 @@ namespace RectBinPack {
 	 * They are called toRect and fromBinRect. They have to be overloaded for each custom type. The index of empty
 	 * rectangles is always set to InvalidBin.
 	 *
+	 * Without merging, free rectangles where none of the remaining rectangles fit are set aside while packing. This
+	 * reorders the other free rectangles, so equally good placements can be chosen differently than before this was
+	 * added. The exact layout isn't guaranteed to stay the same between versions.
+	 *
 	 * \param config Configuration to use for packing
 	 * \param begin Begin iterator of the sequence of rectangles
 	 * \param end End iterator of the sequence of rectangles
@@ -354,7 +1109,7 @@ namespace RectBinPack {
 	template<typename It, typename ItEnd>
 	Result packGuillotine(const GuillotineConfiguration& config, It begin, ItEnd end, std::size_t size = 0) {
 		Internal::Guillotine<It> guillotine(begin, end, size, config);
-		return { !guillotine.pack(), guillotine.numBins() };
+		return { !guillotine.pack(), guillotine.numBins(), guillotine.peakMemory() };
 	}
 
 	/**
@@ -374,6 +1129,56 @@ namespace RectBinPack {
 		return packGuillotine(config, std::begin(collection), std::end(collection), Internal::size(collection));
 	}
 
+	/// \cond INTERNAL
+	namespace Internal {
+		/// Packs rectangles with the algorithm matching the configuration type
+		template<typename It, typename ItEnd>
+		Result pack(const GuillotineConfiguration& config, It begin, ItEnd end, std::size_t size) {
+			return packGuillotine(config, begin, end, size);
+		}
+
+		/// Checks for every rectangle in \p rects if it fits into an empty bin of the configuration
+		inline std::vector<bool> fitsEmptyBin(const GuillotineConfiguration& config, const std::vector<Rect>& rects) {
+			std::vector<BinRect> none;
+			const Guillotine<std::vector<BinRect>::iterator> guillotine(none.begin(), none.end(), 0, config);
+			std::vector<bool> fits(rects.size());
+
+			for (std::size_t i = 0; i < rects.size(); ++i)
+				fits[i] = guillotine.fits(rects[i]);
+
+			return fits;
+		}
+
+		/// Adds every option of the configuration to \p hasher
+		inline void hash(Hasher& hasher, const GuillotineConfiguration& config) {
+			hasher.add('G');
+			hasher.add(config.width);
+			hasher.add(config.height);
+			hasher.add(config.minBins);
+			hasher.add(config.maxBins);
+			hasher.add(config.canFlip);
+			hasher.add(config.merge);
+			hasher.add(config.rectHeuristic);
+			hasher.add(config.splitHeuristic);
+			hasher.add(config.borderPadding);
+			hasher.add(config.spacing);
+			hasher.add(config.alignment);
+			hasher.add(config.obstacles.size());
+
+			for (auto& obstacle : config.obstacles) {
+				hasher.add(obstacle.x);
+				hasher.add(obstacle.y);
+				hasher.add(obstacle.width);
+				hasher.add(obstacle.height);
+			}
+
+			hasher.add(config.binSelection);
+			hasher.add(config.sequential);
+			hasher.add(config.stopEarly);
+		}
+	}
+	/// \endcond
+
 	/**
 	 * @}
 	 */
@@ -8,6 +8,10 @@
 #include "RectBinPack.hpp"
 
 #include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <queue>
+#include <tuple>
 #include <vector>
 
 namespace RectBinPack {
@@ -25,6 +29,12 @@ namespace RectBinPack {
 		ContactPointRule  ///< Use rect where the most sides are shared
 	};
 
+	/// Free rectangles which are discarded first once a bin has too many of them
+	enum class MaxRectsEviction {
+		SmallestArea, ///< Discard the free rectangles with the smallest area
+		Thinnest      ///< Discard the free rectangles with the shortest side
+	};
+
 	/// Configuration for the packing function
 	struct MaxRectsConfiguration {
 		unsigned int width; ///< Width of the bin
@@ -33,10 +43,104 @@ namespace RectBinPack {
 		int maxBins; ///< Maximum number of bins. Defaults to UnlimitedBins if less than 1
 		bool canFlip; ///< Allows for flipping of the rectangles
 		MaxRectsHeuristic rectHeuristic; ///< Heuristic to use
+		unsigned int borderPadding; ///< Space between the rectangles and the edges of the bin
+		unsigned int spacing; ///< Space between two rectangles
+		unsigned int alignment; ///< Positions and occupied sizes are multiples of it. Defaults to 1 if 0
+		std::vector<Rect> obstacles; ///< Regions which are blocked in every bin, in bin coordinates
+
+		/**
+		 * \brief Keeps the best candidate of every free rectangle in a priority queue
+		 *
+		 * Only free rectangles created by a split are scored, instead of all free rectangles for every placement.
+		 * Ties are broken differently, so the layout can differ. Ignored for MaxRectsHeuristic::ContactPointRule.
+		 */
+		bool candidateQueue;
+
+		/**
+		 * \brief Number of placements into a bin between removing the free rectangles which are inside others
+		 *
+		 * Free rectangles inside others are still valid places, so removing them can be deferred. The layout can
+		 * differ if it's greater than 1. Defaults to 1 if 0.
+		 */
+		unsigned int pruneInterval;
+
+		/// Removes the free rectangles inside others early once a bin has more free rectangles. Ignored if 0
+		unsigned int pruneThreshold;
+
+		/**
+		 * \brief Maximum number of free rectangles per bin. Unlimited if 0
+		 *
+		 * Bounds the time and memory per placement. Discarded free rectangles are lost, so more bins can be needed.
+		 */
+		unsigned int maxFreeRects;
+
+		MaxRectsEviction eviction; ///< Free rectangles to discard once there are more than maxFreeRects
+
+		/**
+		 * \brief Policy for choosing the open bin
+		 *
+		 * Every policy except BinSelection::GlobalBest stops at the first bin where any rectangle fits, which
+		 * disables the candidate queue.
+		 */
+		BinSelection binSelection;
+
+		/**
+		 * \brief Stops packing as soon as the rectangles left can't fit into the last bin anymore
+		 *
+		 * Once the maximum number of bins is open, the area and the size of the rectangles left are compared with
+		 * the free space before every placement. Saves time if packing is going to fail, but all rectangles which
+		 * weren't placed yet are set to InvalidBin, even those which would still have fit.
+		 */
+		bool stopEarly;
 	};
 
 	/// \cond INTERNAL
 	namespace Internal {
+		/// Bin of the %MaxRects algorithm
+		struct MaxRectsBin {
+			std::vector<Rect> freeRects;
+			std::vector<Rect> usedRects;
+			unsigned int minTop; // Lowest top of all free rectangles
+			unsigned int minArea; // Smallest area of all free rectangles
+			unsigned int maxWidth; // Largest width of all free rectangles
+			unsigned int maxHeight; // Largest height of all free rectangles
+			unsigned int maxArea; // Largest area of all free rectangles
+
+			// Free rectangles which are too small for the rectangles left. They're still split by placements, so they
+			// can be restored once packing is done.
+			std::vector<Rect> parkedRects;
+
+			unsigned int unprunedSplits; // Placements since the free rectangles inside others were removed
+
+			/// Returns the approximate number of bytes allocated by the bin
+			std::size_t memoryUsage() const {
+				return (freeRects.capacity() + usedRects.capacity() + parkedRects.capacity()) * sizeof(Rect);
+			}
+
+			/// Recalculates the bounds of the free rectangles
+			void updateBounds() {
+				minTop = std::numeric_limits<unsigned int>::max();
+				minArea = std::numeric_limits<unsigned int>::max();
+				maxWidth = 0;
+				maxHeight = 0;
+				maxArea = 0;
+
+				for (auto& freeRect : freeRects) {
+					minTop = std::min(minTop, freeRect.top());
+					minArea = std::min(minArea, freeRect.width * freeRect.height);
+					maxWidth = std::max(maxWidth, freeRect.width);
+					maxHeight = std::max(maxHeight, freeRect.height);
+					maxArea = std::max(maxArea, freeRect.width * freeRect.height);
+				}
+			}
+		};
+
+		/// Bins of the %MaxRects algorithm, which can be packed into again later
+		struct MaxRectsState {
+			std::vector<MaxRectsBin> bins; ///< All bins. Closed bins have no free rectangles.
+			std::uint64_t freeArea; ///< Area left in the open bins
+		};
+
 		/// Implementation of the %MaxRects algorithm
 		template<typename It>
 		class MaxRects {
@@ -55,19 +159,26 @@ namespace RectBinPack {
 			 */
 			template<typename ItEnd>
 			MaxRects(It begin, ItEnd end, std::size_t size, const MaxRectsConfiguration& config):
-				m_config(config) {
+				m_config(config), m_layout(config.width, config.height, config.borderPadding, config.spacing, config.alignment) {
 
+				initEmptyBin();
 				m_rects.reserve(size);
 
 				for (auto it = begin; it != end; ++it) {
-					const auto rect = toRect(*it);
+					const auto original = toRect(*it);
+					const auto rect = m_layout.inflate(original);
 
-					if (rect.width > config.width || rect.height > config.height)
-						if (!config.canFlip || (rect.height > config.width || rect.width > config.height))
+					if (rect.width > m_layout.width() || rect.height > m_layout.height())
+						if (!config.canFlip || (rect.height > m_layout.width() || rect.width > m_layout.height()))
 							throw RectangleTooLargeError("rectangle is too large");
 
-					if (rect.width > 0 && rect.height > 0)
-						m_rects.push_back(it);
+					if (original.width > 0 && original.height > 0) {
+						if (!fitsEmptyBin(rect))
+							throw RectangleTooLargeError("rectangle doesn't fit next to the obstacles");
+
+						m_rects.add(it, rect);
+						m_pendingArea += (std::uint64_t) rect.width * rect.height;
+					}
 					else
 						fromBinRect(*it, { { 0, 0, 0, 0 }, InvalidBin, false });
 				}
@@ -79,103 +190,138 @@ namespace RectBinPack {
 			 * \returns true, if packing succeeded
 			 */
 			bool pack() {
-				m_bins = std::vector<Bin> {
-					(unsigned int) std::max(1, m_config.minBins),
-					Bin { std::vector<Rect> { Rect { 0, 0, m_config.width, m_config.height } }, {} }
-				};
+				m_memory = 0;
+
+				for (auto& bin : m_bins)
+					m_memory += bin.memoryUsage();
+
+				// The groups don't grow while packing
+				m_rectsMemory = m_rects.memoryUsage();
+				m_sortedMemory = 0;
+				m_peakMemory = 0;
+				updatePeakMemory();
+
+				if (m_bins.empty()) {
+					m_freeArea = 0;
+
+					for (auto i = 0; i < std::max(1, m_config.minBins); ++i)
+						addBin();
+				}
+
+				if (useCandidateQueue())
+					initCandidates();
 
 				while (!m_rects.empty()) {
 					FindResult findResult;
 
+					// Stop early if the outcome is already known
+					if (m_config.stopEarly && isLastBin() && cannotFit())
+						return fail();
+
 					// If it couldn't find a free spot, add bin
 					if (!findBest(findResult)) {
-						if (m_config.maxBins > 0 && m_bins.size() >= (unsigned int) m_config.maxBins) {
-							for (auto& rect : m_rects)
-								fromBinRect(*rect, {
-									toRect(*rect),
-									InvalidBin,
-									false
-								});
-
-							return false;
-						}
+						if (isLastBin())
+							return fail();
 
 						for (auto& bin : m_bins)
-							bin.freeRects.clear();
+							closeBin(bin);
+
+						m_freeArea = 0;
+						addBin();
+
+						if (useCandidateQueue())
+							initCandidates();
 
-						m_bins.push_back({ std::vector<Rect> { Rect { 0, 0, m_config.width, m_config.height } }, {} });
 						continue;
 					}
 
 					const auto binIndex = (unsigned int) std::distance(m_bins.begin(), findResult.bin);
 					const auto& occupiedRect = findResult.occupiedRect;
+					const auto it = m_rects.take(findResult.group);
 
-					fromBinRect(**findResult.rect, {
-						occupiedRect,
+					fromBinRect(*it, {
+						m_layout.place(occupiedRect, toRect(*it), findResult.flip),
 						binIndex,
 						findResult.flip
 					});
 
-					auto& bin = *findResult.bin;
-					auto& freeRects = bin.freeRects;
-					const auto freeRectsSize = freeRects.size();
+					// Free rectangles where none of the rectangles left fit are parked
+					const auto bounds = getBounds();
+					const auto memory = findResult.bin->memoryUsage();
 
-					// Split rectangles and "remove" old ones
-					for (auto i = 0u; i < freeRectsSize; ++i) {
-						if (!occupiedRect.intersect(freeRects[i]))
-							continue;
+					splitFreeRects(*findResult.bin, occupiedRect, &bounds);
+					trackMemory(memory, findResult.bin->memoryUsage());
 
-						if (occupiedRect.left() < freeRects[i].right() && occupiedRect.right() > freeRects[i].left()) {
-							if (occupiedRect.top() > freeRects[i].top() && occupiedRect.top() < freeRects[i].bottom())
-								freeRects.push_back({ freeRects[i].left(), freeRects[i].top(), freeRects[i].width, occupiedRect.top() - freeRects[i].top() });
+					if (useCandidateQueue())
+						updateCandidates(binIndex);
 
-							if (occupiedRect.bottom() < freeRects[i].bottom())
-								freeRects.push_back({ freeRects[i].left(), occupiedRect.bottom(), freeRects[i].width, freeRects[i].bottom() - occupiedRect.bottom() });
-						}
+					m_pendingArea -= (std::uint64_t) occupiedRect.width * occupiedRect.height;
+					m_freeArea -= (std::uint64_t) occupiedRect.width * occupiedRect.height;
+				}
 
-						if (occupiedRect.top() < freeRects[i].bottom() && occupiedRect.bottom() > freeRects[i].top()) {
-							if (occupiedRect.left() > freeRects[i].left() && occupiedRect.left() < freeRects[i].right())
-								freeRects.push_back({ freeRects[i].left(), freeRects[i].top(), occupiedRect.left() - freeRects[i].left(), freeRects[i].height });
+				return true;
+			}
 
-							if (occupiedRect.right() < freeRects[i].right())
-								freeRects.push_back({ occupiedRect.right(), freeRects[i].top(), freeRects[i].right() - occupiedRect.right(), freeRects[i].height });
-						}
+			/**
+			 * \brief Packs the rectangles into the bins of \p state
+			 *
+			 * Bins are only added if needed. The bins are stored in \p state afterwards. Parked free rectangles are
+			 * restored, so smaller rectangles can be packed into them later.
+			 *
+			 * \returns true, if packing succeeded
+			 */
+			bool pack(MaxRectsState& state) {
+				m_bins.swap(state.bins);
+				m_freeArea = state.freeArea;
 
-						freeRects[i] = {};
-					}
+				const auto result = pack();
 
-					// Remove empty rects
-					freeRects.erase(std::remove(freeRects.begin(), freeRects.end(), Rect {}), freeRects.end());
+				for (auto& bin : m_bins)
+					restoreParkedRects(bin);
 
-					// Remove if inside another rectangle
-					for (auto i = freeRects.begin(); i != freeRects.end();) {
-						auto redo = false;
+				m_bins.swap(state.bins);
+				state.freeArea = m_freeArea;
+				return result;
+			}
 
-						for (auto j = std::next(i); j != freeRects.end(); ++j) {
-							if (i->isContainedIn(*j)) {
-								swapAndPop(freeRects, i);
-								redo = true;
-								break;
-							}
-							else if (j->isContainedIn(*i)) {
-								swapAndPop(freeRects, j--);
-								continue;
-							}
-						}
+			/**
+			 * \brief Occupies space in a bin of \p state before packing, so nothing else is placed there
+			 *
+			 * Bins are added until the bin exists and the minimum number of bins is reached.
+			 *
+			 * \param state Bins to modify
+			 * \param binIndex Index of the bin
+			 * \param occupiedRect Space inside the packing area of the bin
+			 * \returns false, if the space isn't free
+			 */
+			bool occupy(MaxRectsState& state, unsigned int binIndex, const Rect& occupiedRect) {
+				m_bins.swap(state.bins);
+				m_freeArea = state.freeArea;
 
-						if (!redo)
-							++i;
-					}
+				if (m_bins.empty())
+					m_freeArea = 0;
+
+				while (m_bins.size() < (unsigned int) std::max(1, m_config.minBins))
+					addBin();
+
+				// Bins which don't exist yet are checked against an empty bin, so they are only added if needed
+				const auto& target = binIndex < m_bins.size() ? m_bins[binIndex] : m_emptyBin;
 
-					// Add rect to used vector
-					if (m_config.rectHeuristic == MaxRectsHeuristic::ContactPointRule)
-						bin.usedRects.push_back(occupiedRect);
+				const auto isFree = std::any_of(target.freeRects.begin(), target.freeRects.end(), [&](const Rect& freeRect) {
+					return occupiedRect.isContainedIn(freeRect);
+				});
 
-					// Remove rect
-					m_rects.erase(findResult.rect);
+				if (isFree) {
+					while (m_bins.size() <= binIndex)
+						addBin();
+
+					splitFreeRects(m_bins[binIndex], occupiedRect);
+					m_freeArea -= (std::uint64_t) occupiedRect.width * occupiedRect.height;
 				}
 
-				return true;
+				m_bins.swap(state.bins);
+				state.freeArea = m_freeArea;
+				return isFree;
 			}
 
 			/// Returns the number of bins used
@@ -183,24 +329,74 @@ namespace RectBinPack {
 				return m_bins.size();
 			}
 
+			/// Returns the approximate peak number of bytes used during the last call to pack
+			std::size_t peakMemory() const {
+				return m_peakMemory;
+			}
+
+			/// Checks if a rectangle of the size of \p rect fits into an empty bin next to the obstacles
+			bool fits(const Rect& rect) const {
+				const auto size = m_layout.inflate(rect);
+
+				if (size.width > m_layout.width() || size.height > m_layout.height())
+					if (!m_config.canFlip || (size.height > m_layout.width() || size.width > m_layout.height()))
+						return false;
+
+				return fitsEmptyBin(size);
+			}
+
+			/**
+			 * Scores every candidate instead of skipping the ones which can't beat the best so far. Only used to test that
+			 * skipping doesn't change the result.
+			 */
+			void disableLowerBound() {
+				m_useLowerBound = false;
+			}
+
 		private:
-			struct Bin {
-				std::vector<Rect> freeRects;
-				std::vector<Rect> usedRects;
+			using Bin = MaxRectsBin;
+
+			// Bounds of the rectangles which are left for packing
+			struct Bounds {
+				unsigned int minWidth;
+				unsigned int minHeight;
+				unsigned int minArea;
+				unsigned int maxArea;
+				unsigned int maxWidth;
+				unsigned int maxHeight;
+				unsigned int maxShortSide;
+				unsigned int maxLongSide;
 			};
 
-			using RectIt = typename std::vector<It>::iterator;
 			using BinIt = typename std::vector<Bin>::iterator;
 			using FreeRectIt = typename std::vector<Rect>::iterator;
 
 			struct FindResult {
-				RectIt rect;
+				std::size_t group;
 				Rect occupiedRect;
 				BinIt bin;
 				FreeRectIt freeRect;
 				bool flip;
 			};
 
+			// Best placement into a free rectangle, for the candidate queue
+			struct Candidate {
+				unsigned int score1;
+				unsigned int score2;
+				std::size_t bin;
+				std::size_t group;
+				bool flip;
+				Rect freeRect;
+			};
+
+			// Orders the candidate queue, so the lowest scores are on top
+			struct CandidateOrder {
+				bool operator()(const Candidate& a, const Candidate& b) const {
+					return std::tie(a.score1, a.score2, a.bin, a.freeRect.y, a.freeRect.x, a.group, a.flip) >
+						std::tie(b.score1, b.score2, b.bin, b.freeRect.y, b.freeRect.x, b.group, b.flip);
+				}
+			};
+
 			void getScore(const Rect& dest, unsigned int w, unsigned int h, unsigned int& score1, unsigned int& score2) {
 				switch (m_config.rectHeuristic) {
 				case MaxRectsHeuristic::BestShortSideFit:
@@ -225,10 +421,10 @@ namespace RectBinPack {
 			unsigned int getScoreContactPoint(const std::vector<Rect>& usedRects, Rect rect) {
 				auto score = 0u;
 
-				if (rect.left() == 0 || rect.right() == m_config.width)
+				if (rect.left() == 0 || rect.right() == m_layout.width())
 					score += rect.width;
 
-				if (rect.top() == 0 || rect.bottom() == m_config.height)
+				if (rect.top() == 0 || rect.bottom() == m_layout.height())
 					score += rect.height;
 
 				for (auto& other : usedRects) {
@@ -242,20 +438,456 @@ namespace RectBinPack {
 				return score;
 			}
 
+			/// Splits every rectangle intersecting \p occupiedRect into the parts around it, which are appended
+			static void splitRects(std::vector<Rect>& rects, const Rect& occupiedRect) {
+				const auto size = rects.size();
+
+				// Split rectangles and "remove" old ones
+				for (auto i = 0u; i < size; ++i) {
+					if (!occupiedRect.intersect(rects[i]))
+						continue;
+
+					const auto rect = rects[i];
+
+					if (occupiedRect.left() < rect.right() && occupiedRect.right() > rect.left()) {
+						if (occupiedRect.top() > rect.top() && occupiedRect.top() < rect.bottom())
+							rects.push_back({ rect.left(), rect.top(), rect.width, occupiedRect.top() - rect.top() });
+
+						if (occupiedRect.bottom() < rect.bottom())
+							rects.push_back({ rect.left(), occupiedRect.bottom(), rect.width, rect.bottom() - occupiedRect.bottom() });
+					}
+
+					if (occupiedRect.top() < rect.bottom() && occupiedRect.bottom() > rect.top()) {
+						if (occupiedRect.left() > rect.left() && occupiedRect.left() < rect.right())
+							rects.push_back({ rect.left(), rect.top(), occupiedRect.left() - rect.left(), rect.height });
+
+						if (occupiedRect.right() < rect.right())
+							rects.push_back({ occupiedRect.right(), rect.top(), rect.right() - occupiedRect.right(), rect.height });
+					}
+
+					rects[i] = {};
+				}
+
+				// Remove empty rects
+				rects.erase(std::remove(rects.begin(), rects.end(), Rect {}), rects.end());
+			}
+
+			/**
+			 * \brief Removes \p occupiedRect from the free rectangles of the bin
+			 *
+			 * If \p bounds is set, free rectangles where none of the rectangles left fit are parked before the
+			 * rectangles inside others are removed, so they don't take part in it anymore.
+			 */
+			void splitFreeRects(Bin& bin, const Rect& occupiedRect, const Bounds* bounds = nullptr) {
+				splitRects(bin.freeRects, occupiedRect);
+				splitRects(bin.parkedRects, occupiedRect);
+
+				if (bounds) {
+					const auto parked = std::stable_partition(bin.freeRects.begin(), bin.freeRects.end(), [&](const Rect& freeRect) {
+						return !cannotFitInto(*bounds, freeRect.width, freeRect.height, freeRect.width * freeRect.height);
+					});
+
+					bin.parkedRects.insert(bin.parkedRects.end(), parked, bin.freeRects.end());
+					bin.freeRects.erase(parked, bin.freeRects.end());
+				}
+
+				++bin.unprunedSplits;
+
+				const auto isDue =
+					bin.unprunedSplits >= std::max(1u, m_config.pruneInterval) ||
+					(m_config.pruneThreshold > 0 && bin.freeRects.size() > m_config.pruneThreshold);
+
+				if (isDue)
+					pruneFreeRects(bin);
+
+				if (m_config.maxFreeRects > 0 && bin.freeRects.size() > m_config.maxFreeRects)
+					evictFreeRects(bin.freeRects);
+
+				bin.updateBounds();
+
+				// Add rect to used vector
+				if (m_config.rectHeuristic == MaxRectsHeuristic::ContactPointRule)
+					bin.usedRects.push_back(occupiedRect);
+			}
+
+			/// Releases the storage of a bin which is never packed into again
+			void closeBin(Bin& bin) {
+				const auto memory = bin.memoryUsage();
+
+				std::vector<Rect>().swap(bin.freeRects);
+				std::vector<Rect>().swap(bin.usedRects);
+				std::vector<Rect>().swap(bin.parkedRects);
+				bin.updateBounds();
+
+				trackMemory(memory, 0);
+			}
+
+			/// Moves the parked rectangles back to the free rectangles of the bin and removes the ones inside others
+			void restoreParkedRects(Bin& bin) {
+				if (bin.parkedRects.empty() && bin.unprunedSplits == 0)
+					return;
+
+				bin.freeRects.insert(bin.freeRects.end(), bin.parkedRects.begin(), bin.parkedRects.end());
+				bin.parkedRects.clear();
+
+				pruneFreeRects(bin);
+				bin.updateBounds();
+			}
+
+			/// Discards free rectangles according to the eviction policy until maxFreeRects are left
+			void evictFreeRects(std::vector<Rect>& freeRects) {
+				const auto key = [&](const Rect& rect) {
+					const auto area = (std::uint64_t) rect.width * rect.height;
+
+					if (m_config.eviction == MaxRectsEviction::Thinnest)
+						return std::make_pair((std::uint64_t) std::min(rect.width, rect.height), area);
+
+					return std::make_pair(area, (std::uint64_t) std::min(rect.width, rect.height));
+				};
+
+				std::vector<std::size_t> order(freeRects.size());
+
+				for (std::size_t i = 0; i < order.size(); ++i)
+					order[i] = i;
+
+				std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+					return key(freeRects[a]) < key(freeRects[b]);
+				});
+
+				// Mark the rectangles to discard, so the others keep their order
+				for (std::size_t i = 0; i < freeRects.size() - m_config.maxFreeRects; ++i)
+					freeRects[order[i]] = {};
+
+				freeRects.erase(std::remove(freeRects.begin(), freeRects.end(), Rect {}), freeRects.end());
+			}
+
+			/// Removes the free rectangles which are inside another one
+			static void pruneFreeRects(Bin& bin) {
+				auto& freeRects = bin.freeRects;
+				bin.unprunedSplits = 0;
+
+				// Remove if inside another rectangle
+				for (auto i = freeRects.begin(); i != freeRects.end();) {
+					auto redo = false;
+
+					for (auto j = std::next(i); j != freeRects.end(); ++j) {
+						if (i->isContainedIn(*j)) {
+							swapAndPop(freeRects, i);
+							redo = true;
+							break;
+						}
+						else if (j->isContainedIn(*i)) {
+							swapAndPop(freeRects, j--);
+							continue;
+						}
+					}
+
+					if (!redo)
+						++i;
+				}
+			}
+
+			/// Creates the bin every new bin is copied from. The obstacles are removed from its free space.
+			void initEmptyBin() {
+				m_emptyBin = { std::vector<Rect> { Rect { 0, 0, m_layout.width(), m_layout.height() } }, {}, 0, 0, 0, 0, 0, {}, 0 };
+
+				std::vector<Rect> blocked;
+
+				for (auto& obstacle : m_config.obstacles) {
+					Rect rect;
+
+					if (m_layout.block(obstacle, rect)) {
+						splitFreeRects(m_emptyBin, rect);
+						blocked.push_back(rect);
+					}
+				}
+
+				pruneFreeRects(m_emptyBin);
+				m_emptyBin.updateBounds();
+				m_emptyArea = (std::uint64_t) m_layout.width() * m_layout.height() - getUnionArea(blocked);
+			}
+
+			/// Checks if the space fits into an empty bin
+			bool fitsEmptyBin(const Rect& rect) const {
+				return std::any_of(m_emptyBin.freeRects.begin(), m_emptyBin.freeRects.end(), [&](const Rect& freeRect) {
+					return (rect.width <= freeRect.width && rect.height <= freeRect.height) ||
+						(m_config.canFlip && rect.height <= freeRect.width && rect.width <= freeRect.height);
+				});
+			}
+
+			void addBin() {
+				m_bins.push_back(m_emptyBin);
+				m_freeArea += m_emptyArea;
+				trackMemory(0, m_bins.back().memoryUsage());
+			}
+
+			/// Updates the memory used by the bins after a bin changed from \p before to \p after bytes
+			void trackMemory(std::size_t before, std::size_t after) {
+				m_memory = m_memory - before + after;
+				updatePeakMemory();
+			}
+
+			/// Updates the peak with the memory used by the bins, the rectangles left and the candidate queue
+			void updatePeakMemory() {
+				const auto memory = m_memory + m_bins.capacity() * sizeof(Bin) + m_rectsMemory +
+					m_candidates.size() * sizeof(Candidate) + m_sortedFreeRects.capacity() * sizeof(std::vector<Rect>) +
+					m_sortedMemory;
+
+				m_peakMemory = std::max(m_peakMemory, memory);
+			}
+
+			/// Checks if no more bins can be added
+			bool isLastBin() const {
+				return m_config.maxBins > 0 && m_bins.size() >= (unsigned int) m_config.maxBins;
+			}
+
+			/// Sets the rectangles which are left to InvalidBin
+			bool fail() {
+				m_rects.forEach([](It rect) {
+					fromBinRect(*rect, {
+						toRect(*rect),
+						InvalidBin,
+						false
+					});
+				});
+
+				return false;
+			}
+
+			/**
+			 * Checks if the rectangles left can't be packed into the free space. Free rectangles only shrink, so a
+			 * rectangle which doesn't fit into the largest free width and height never will.
+			 */
+			bool cannotFit() {
+				if (m_pendingArea > m_freeArea)
+					return true;
+
+				auto maxWidth = 0u, maxHeight = 0u;
+
+				for (auto& bin : m_bins) {
+					if (bin.freeRects.empty())
+						continue;
+
+					maxWidth = std::max(maxWidth, bin.maxWidth);
+					maxHeight = std::max(maxHeight, bin.maxHeight);
+				}
+
+				const auto bounds = getBounds();
+
+				if (m_config.canFlip)
+					return bounds.maxShortSide > std::min(maxWidth, maxHeight) || bounds.maxLongSide > std::max(maxWidth, maxHeight);
+
+				return bounds.maxWidth > maxWidth || bounds.maxHeight > maxHeight;
+			}
+
+			Bounds getBounds() {
+				const auto invalid = std::numeric_limits<unsigned int>::max();
+				Bounds bounds { invalid, invalid, invalid, 0, 0, 0, 0, 0 };
+
+				for (auto group : m_rects.active()) {
+					const auto& rect = m_rects[group].size;
+
+					bounds.minWidth = std::min(bounds.minWidth, m_config.canFlip ? std::min(rect.width, rect.height) : rect.width);
+					bounds.minHeight = std::min(bounds.minHeight, m_config.canFlip ? std::min(rect.width, rect.height) : rect.height);
+					bounds.minArea = std::min(bounds.minArea, rect.width * rect.height);
+					bounds.maxArea = std::max(bounds.maxArea, rect.width * rect.height);
+					bounds.maxWidth = std::max(bounds.maxWidth, rect.width);
+					bounds.maxHeight = std::max(bounds.maxHeight, rect.height);
+					bounds.maxShortSide = std::max(bounds.maxShortSide, std::min(rect.width, rect.height));
+					bounds.maxLongSide = std::max(bounds.maxLongSide, std::max(rect.width, rect.height));
+				}
+
+				return bounds;
+			}
+
+			/**
+			 * Returns the lowest first score any rectangle can achieve in a free rectangle with the given top and area.
+			 * A free rectangle or a bin whose bound is worse than the best score so far can be skipped.
+			 */
+			unsigned int getLowerBound(const Bounds& bounds, unsigned int top, unsigned int area) {
+				if (!m_useLowerBound)
+					return 0;
+
+				switch (m_config.rectHeuristic) {
+				case MaxRectsHeuristic::BestAreaFit:
+					return area > bounds.maxArea ? area - bounds.maxArea : 0;
+				case MaxRectsHeuristic::BottomLeftRule:
+					return top + bounds.minHeight;
+				default:
+					return 0;
+				}
+			}
+
+			/**
+			 * Checks if none of the rectangles left fit into free space with the given largest width, height and area.
+			 * A flipped rectangle only fits if its shorter side fits into the shorter side of the free space.
+			 */
+			bool cannotFitInto(const Bounds& bounds, unsigned int width, unsigned int height, unsigned int area) const {
+				if (bounds.minArea > area)
+					return true;
+
+				if (m_config.canFlip)
+					return bounds.minWidth > std::min(width, height);
+
+				return bounds.minWidth > width || bounds.minHeight > height;
+			}
+
+			bool useCandidateQueue() const {
+				return m_config.candidateQueue && m_config.rectHeuristic != MaxRectsHeuristic::ContactPointRule &&
+					m_config.binSelection == BinSelection::GlobalBest;
+			}
+
+			static bool lessRect(const Rect& a, const Rect& b) {
+				return std::tie(a.x, a.y, a.width, a.height) < std::tie(b.x, b.y, b.width, b.height);
+			}
+
+			/// Scores the rectangles left against \p freeRect and queues the best placement
+			void queueCandidate(std::size_t binIndex, const Rect& freeRect) {
+				const auto invalidScore = std::numeric_limits<unsigned int>::max();
+				Candidate best { invalidScore, invalidScore, binIndex, 0, false, freeRect };
+				auto found = false;
+
+				for (auto group : m_rects.active()) {
+					const auto& rect = m_rects[group].size;
+					unsigned int score1, score2;
+
+					if (rect.width <= freeRect.width && rect.height <= freeRect.height) {
+						getScore(freeRect, rect.width, rect.height, score1, score2);
+
+						if (!found || score1 < best.score1 || (score1 == best.score1 && score2 < best.score2)) {
+							best = { score1, score2, binIndex, group, false, freeRect };
+							found = true;
+						}
+					}
+
+					if (m_config.canFlip && rect.height <= freeRect.width && rect.width <= freeRect.height) {
+						getScore(freeRect, rect.height, rect.width, score1, score2);
+
+						if (!found || score1 < best.score1 || (score1 == best.score1 && score2 < best.score2)) {
+							best = { score1, score2, binIndex, group, true, freeRect };
+							found = true;
+						}
+					}
+				}
+
+				if (found)
+					m_candidates.push(best);
+			}
+
+			/// Scores every free rectangle of every bin
+			void initCandidates() {
+				m_candidates = decltype(m_candidates)();
+				m_sortedFreeRects.assign(m_bins.size(), {});
+				m_sortedMemory = 0;
+
+				for (std::size_t i = 0; i < m_bins.size(); ++i) {
+					m_sortedFreeRects[i] = m_bins[i].freeRects;
+					std::sort(m_sortedFreeRects[i].begin(), m_sortedFreeRects[i].end(), lessRect);
+					m_sortedMemory += m_sortedFreeRects[i].capacity() * sizeof(Rect);
+
+					for (auto& freeRect : m_sortedFreeRects[i])
+						queueCandidate(i, freeRect);
+				}
+
+				updatePeakMemory();
+			}
+
+			/// Scores the free rectangles of the bin which were created by the last split
+			void updateCandidates(std::size_t binIndex) {
+				auto sorted = m_bins[binIndex].freeRects;
+				std::sort(sorted.begin(), sorted.end(), lessRect);
+
+				std::vector<Rect> created;
+				const auto& previous = m_sortedFreeRects[binIndex];
+				std::set_difference(sorted.begin(), sorted.end(), previous.begin(), previous.end(), std::back_inserter(created), lessRect);
+
+				for (auto& freeRect : created)
+					queueCandidate(binIndex, freeRect);
+
+				m_sortedMemory = m_sortedMemory - previous.capacity() * sizeof(Rect) + sorted.capacity() * sizeof(Rect);
+				m_sortedFreeRects[binIndex] = std::move(sorted);
+				updatePeakMemory();
+			}
+
+			/**
+			 * Takes the best candidate from the queue. Candidates of free rectangles which were split are dropped.
+			 * If the group of a candidate has no rectangles left, its free rectangle is scored again.
+			 */
+			bool findBestQueued(FindResult& result) {
+				while (!m_candidates.empty()) {
+					const auto candidate = m_candidates.top();
+					m_candidates.pop();
+
+					const auto& sorted = m_sortedFreeRects[candidate.bin];
+
+					if (!std::binary_search(sorted.begin(), sorted.end(), candidate.freeRect, lessRect))
+						continue;
+
+					if (m_rects[candidate.group].count() == 0) {
+						queueCandidate(candidate.bin, candidate.freeRect);
+						continue;
+					}
+
+					auto& bin = m_bins[candidate.bin];
+
+					result = {
+						candidate.group,
+						{},
+						m_bins.begin() + candidate.bin,
+						std::find(bin.freeRects.begin(), bin.freeRects.end(), candidate.freeRect),
+						candidate.flip
+					};
+
+					return setOccupiedRect(result);
+				}
+
+				return false;
+			}
+
 			bool findBest(FindResult& result) {
+				if (useCandidateQueue())
+					return findBestQueued(result);
+
 				const auto invalidScore = std::numeric_limits<unsigned int>::max();
+				const auto bounds = getBounds();
+				const auto bestPossible = m_useLowerBound && m_config.rectHeuristic != MaxRectsHeuristic::ContactPointRule;
 
 				auto bestScore1 = invalidScore;
 				auto bestScore2 = invalidScore;
 
-				for (auto binIt = m_bins.begin(); binIt != m_bins.end(); ++binIt) {
+				// Lowest score any rectangle can achieve in any bin. The search stops as soon as it is reached.
+				auto lowerBound = invalidScore;
+
+				// Bins where none of the rectangles fit are skipped
+				const auto skip = [&](const Bin& bin) {
+					return bin.freeRects.empty() || cannotFitInto(bounds, bin.maxWidth, bin.maxHeight, bin.maxArea);
+				};
+
+				for (auto& bin : m_bins)
+					if (!skip(bin))
+						lowerBound = std::min(lowerBound, getLowerBound(bounds, bin.minTop, bin.minArea));
+
+				for (auto binIndex : getBinOrder(m_config.binSelection, m_bins)) {
+					const auto binIt = m_bins.begin() + binIndex;
 					auto& bin = *binIt;
 
+					// Only the global best placement needs the other bins once a placement was found
+					if (m_config.binSelection != BinSelection::GlobalBest && bestScore1 != invalidScore)
+						break;
+
+					if (skip(bin) || getLowerBound(bounds, bin.minTop, bin.minArea) > bestScore1)
+						continue;
+
 					for (auto freeRectIt = bin.freeRects.begin(); freeRectIt != bin.freeRects.end(); ++freeRectIt) {
 						auto& freeRect = *freeRectIt;
+						const auto area = freeRect.width * freeRect.height;
+
+						if (cannotFitInto(bounds, freeRect.width, freeRect.height, area) || getLowerBound(bounds, freeRect.top(), area) > bestScore1)
+							continue;
 
-						for (auto rectIt = m_rects.begin(); rectIt != m_rects.end(); ++rectIt) {
-							const auto rect = toRect(**rectIt);
+						// Rectangles of the same size get the same score, so only the first one of every group is tried
+						for (auto group : m_rects.active()) {
+							const auto& rect = m_rects[group].size;
 
 							if (rect.width <= freeRect.width && rect.height <= freeRect.height) {
 								unsigned int score1, score2 = invalidScore;
@@ -268,7 +900,7 @@ namespace RectBinPack {
 									getScore(freeRect, rect.width, rect.height, score1, score2);
 
 								if (score1 < bestScore1 || (score1 == bestScore1 && score2 < bestScore2)) {
-									result = { rectIt, {}, binIt, freeRectIt, false };
+									result = { group, {}, binIt, freeRectIt, false };
 									bestScore1 = score1;
 									bestScore2 = score2;
 								}
@@ -285,34 +917,54 @@ namespace RectBinPack {
 									getScore(freeRect, rect.height, rect.width, score1, score2);
 
 								if (score1 < bestScore1 || (score1 == bestScore1 && score2 < bestScore2)) {
-									result = { rectIt, {}, binIt, freeRectIt, true };
+									result = { group, {}, binIt, freeRectIt, true };
 									bestScore1 = score1;
 									bestScore2 = score2;
 								}
 							}
+
+							// Nothing can beat the lowest possible score, since only better scores replace the result
+							if (bestPossible && bestScore1 == lowerBound && bestScore2 == 0)
+								return setOccupiedRect(result);
 						}
 					}
 				}
 
-				if (bestScore1 != invalidScore) {
-					const auto rect = toRect(**result.rect);
+				if (bestScore1 == invalidScore)
+					return false;
 
-					const Rect occupiedRect {
-						result.freeRect->x,
-						result.freeRect->y,
-						rect.width,
-						rect.height
-					};
+				return setOccupiedRect(result);
+			}
 
-					result.occupiedRect = result.flip ? occupiedRect.flipped() : occupiedRect;
-				}
+			bool setOccupiedRect(FindResult& result) {
+				const auto& rect = m_rects[result.group].size;
 
-				return bestScore1 != invalidScore;
+				const Rect occupiedRect {
+					result.freeRect->x,
+					result.freeRect->y,
+					rect.width,
+					rect.height
+				};
+
+				result.occupiedRect = result.flip ? occupiedRect.flipped() : occupiedRect;
+				return true;
 			}
 
 			const MaxRectsConfiguration& m_config;
-			std::vector<It> m_rects;
+			const Layout m_layout;
+			RectGroups<It> m_rects;
 			std::vector<Bin> m_bins;
+			std::uint64_t m_pendingArea = 0; // Area of the rectangles left for packing
+			std::uint64_t m_freeArea = 0; // Area left in the open bins
+			Bin m_emptyBin;
+			std::uint64_t m_emptyArea = 0; // Free area of an empty bin
+			std::size_t m_memory = 0; // Memory used by the free and used rectangles of all bins
+			std::size_t m_rectsMemory = 0; // Memory used by the groups of rectangles
+			std::size_t m_sortedMemory = 0; // Memory used by the free rectangles in m_sortedFreeRects
+			std::size_t m_peakMemory = 0;
+			std::priority_queue<Candidate, std::vector<Candidate>, CandidateOrder> m_candidates;
+			std::vector<std::vector<Rect>> m_sortedFreeRects; // Free rectangles of every bin for looking up candidates
+			bool m_useLowerBound = true;
 		};
 	}
 	/// \endcond
@@ -324,6 +976,10 @@ namespace RectBinPack {
 	 * They are called toRect and fromBinRect. They have to be overloaded for each custom type. The index of empty
 	 * rectangles is always set to InvalidBin.
 	 *
+	 * Free rectangles where none of the remaining rectangles fit are set aside while packing. The remaining free
+	 * rectangles end up in a different order, so ties between equally good placements can be broken differently than
+	 * before this was added. The exact layout isn't guaranteed to stay the same between versions.
+	 *
 	 * \param config Configuration to use for packing
 	 * \param begin Begin iterator of the sequence of rectangles
 	 * \param end End iterator of the sequence of rectangles
@@ -334,7 +990,7 @@ namespace RectBinPack {
 	template<typename It, typename ItEnd>
 	Result packMaxRects(const MaxRectsConfiguration& config, It begin, ItEnd end, std::size_t size = 0) {
 		Internal::MaxRects<It> maxRects(begin, end, size, config);
-		return { !maxRects.pack(), maxRects.numBins() };
+		return { !maxRects.pack(), maxRects.numBins(), maxRects.peakMemory() };
 	}
 
 	/**
@@ -354,6 +1010,58 @@ namespace RectBinPack {
 		return packMaxRects(config, std::begin(collection), std::end(collection), Internal::size(collection));
 	}
 
+	/// \cond INTERNAL
+	namespace Internal {
+		/// Packs rectangles with the algorithm matching the configuration type
+		template<typename It, typename ItEnd>
+		Result pack(const MaxRectsConfiguration& config, It begin, ItEnd end, std::size_t size) {
+			return packMaxRects(config, begin, end, size);
+		}
+
+		/// Checks for every rectangle in \p rects if it fits into an empty bin of the configuration
+		inline std::vector<bool> fitsEmptyBin(const MaxRectsConfiguration& config, const std::vector<Rect>& rects) {
+			std::vector<BinRect> none;
+			const MaxRects<std::vector<BinRect>::iterator> maxRects(none.begin(), none.end(), 0, config);
+			std::vector<bool> fits(rects.size());
+
+			for (std::size_t i = 0; i < rects.size(); ++i)
+				fits[i] = maxRects.fits(rects[i]);
+
+			return fits;
+		}
+
+		/// Adds every option of the configuration to \p hasher
+		inline void hash(Hasher& hasher, const MaxRectsConfiguration& config) {
+			hasher.add('M');
+			hasher.add(config.width);
+			hasher.add(config.height);
+			hasher.add(config.minBins);
+			hasher.add(config.maxBins);
+			hasher.add(config.canFlip);
+			hasher.add(config.rectHeuristic);
+			hasher.add(config.borderPadding);
+			hasher.add(config.spacing);
+			hasher.add(config.alignment);
+			hasher.add(config.obstacles.size());
+
+			for (auto& obstacle : config.obstacles) {
+				hasher.add(obstacle.x);
+				hasher.add(obstacle.y);
+				hasher.add(obstacle.width);
+				hasher.add(obstacle.height);
+			}
+
+			hasher.add(config.candidateQueue);
+			hasher.add(config.pruneInterval);
+			hasher.add(config.pruneThreshold);
+			hasher.add(config.maxFreeRects);
+			hasher.add(config.eviction);
+			hasher.add(config.binSelection);
+			hasher.add(config.stopEarly);
+		}
+	}
+	/// \endcond
+
 	/**
 	 * @}
 	 */
@@ -0,0 +1,318 @@
+/**
+ * \file MinimumSize.hpp
+ * Search for the smallest bin which fits all rectangles
+ */
+
+#pragma once
+
+#include "RectBinPack.hpp"
+#include "Guillotine.hpp"
+#include "MaxRects.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace RectBinPack {
+	/**
+	 * \addtogroup MinimumSize
+	 * @{
+	 */
+
+	/// Constraints for the bin size search
+	struct SizeSearchConfiguration {
+		unsigned int maxWidth; ///< Maximum width of the bin
+		unsigned int maxHeight; ///< Maximum height of the bin
+		bool powerOfTwo; ///< Only use widths and heights which are powers of two
+		bool square; ///< Only use bins with the same width and height
+		unsigned int maxAspect; ///< Maximum ratio of the longer to the shorter side. Unlimited if 0
+		unsigned int granularity; ///< Widths and heights are multiples of it. Defaults to 1 if 0
+	};
+
+	/// \cond INTERNAL
+	namespace Internal {
+		/// Implementation of the bin size search
+		template<typename Configuration, typename It, typename ItEnd>
+		class SizeSearch {
+		public:
+			/**
+			 * \brief Constructs the class and calculates the lower bounds of the bin size
+			 *
+			 * \param config Configuration of the algorithm. Its width and height are set to the size found.
+			 * \param search Constraints for the bin size
+			 * \param begin Begin iterator of the sequence
+			 * \param end End iterator of the sequence
+			 * \param size Size of the sequence. Passed on to the packing function, can be set to 0
+			 */
+			SizeSearch(Configuration& config, const SizeSearchConfiguration& search, It begin, ItEnd end, std::size_t size):
+				m_config(config), m_search(search), m_begin(begin), m_end(end), m_size(size) {
+
+				// Attempts only have to tell if everything fits, so they give up as soon as it can't
+				m_attempt = config;
+				m_attempt.minBins = 1;
+				m_attempt.maxBins = 1;
+				m_attempt.stopEarly = true;
+
+				m_rects.reserve(size);
+
+				for (auto it = begin; it != end; ++it) {
+					const auto rect = toRect(*it);
+
+					if (rect.width == 0 || rect.height == 0)
+						continue;
+
+					m_rects.push_back({ { 0, 0, rect.width, rect.height }, InvalidBin, false });
+
+					const auto shortSide = std::min(rect.width, rect.height);
+					const auto longSide = std::max(rect.width, rect.height);
+
+					m_area += (std::uint64_t) rect.width * rect.height;
+					m_minWidth = std::max(m_minWidth, config.canFlip ? shortSide : rect.width);
+					m_minHeight = std::max(m_minHeight, config.canFlip ? shortSide : rect.height);
+					m_minLongSide = std::max(m_minLongSide, longSide);
+				}
+			}
+
+			/**
+			 * \brief Searches the size and packs the rectangles into it
+			 *
+			 * \returns Result of packing with the size found, or with the maximum size if nothing fits
+			 */
+			Result pack() {
+				if (m_search.square)
+					searchSquare();
+				else
+					searchRectangle();
+
+				if (m_bestArea == noArea) {
+					m_bestWidth = m_search.maxWidth;
+					m_bestHeight = m_search.maxHeight;
+				}
+
+				m_config.width = m_bestWidth;
+				m_config.height = m_bestHeight;
+
+				m_attempt.width = m_bestWidth;
+				m_attempt.height = m_bestHeight;
+				m_attempt.stopEarly = m_config.stopEarly;
+
+				// The last attempt isn't necessarily the best one, repeat the best one with the real rectangles
+				try {
+					return Internal::pack(m_attempt, m_begin, m_end, m_size);
+				}
+				catch (const RectangleTooLargeError&) {
+					// The exception can be thrown after some rectangles were set, none of them are packed
+					for (auto it = m_begin; it != m_end; ++it) {
+						const auto rect = toRect(*it);
+						fromBinRect(*it, { { 0, 0, rect.width, rect.height }, InvalidBin, false });
+					}
+
+					return { true, 0, 0 };
+				}
+			}
+
+		private:
+			static const std::uint64_t noArea = std::numeric_limits<std::uint64_t>::max();
+
+			/// Returns all sizes from \p min to \p max which satisfy the constraints
+			std::vector<unsigned int> getSizes(unsigned int min, unsigned int max) const {
+				const auto granularity = std::max(1u, m_search.granularity);
+
+				std::vector<unsigned int> sizes;
+
+				if (m_search.powerOfTwo) {
+					for (std::uint64_t size = 1; size <= max; size *= 2)
+						if (size >= min && size % granularity == 0)
+							sizes.push_back((unsigned int) size);
+				}
+				else {
+					for (std::uint64_t size = (min + granularity - 1) / granularity * granularity; size <= max; size += granularity)
+						sizes.push_back((unsigned int) size);
+				}
+
+				return sizes;
+			}
+
+			/// Checks if \p width x \p height can be a solution at all
+			bool isCandidate(unsigned int width, unsigned int height) const {
+				if (width < m_minWidth || height < m_minHeight || std::max(width, height) < m_minLongSide)
+					return false;
+
+				if ((std::uint64_t) width * height < m_area)
+					return false;
+
+				if (m_search.maxAspect > 0)
+					if ((std::uint64_t) std::max(width, height) > (std::uint64_t) std::min(width, height) * m_search.maxAspect)
+						return false;
+
+				return true;
+			}
+
+			/// Packs the rectangles with the given size and remembers it if it's the best one
+			bool attempt(unsigned int width, unsigned int height) {
+				if (!isCandidate(width, height))
+					return false;
+
+				m_attempt.width = width;
+				m_attempt.height = height;
+
+				// Attempts pack a copy, so that every attempt starts with the same rectangles
+				m_attemptRects = m_rects;
+
+				bool succeeded;
+
+				try {
+					succeeded = !Internal::pack(m_attempt, m_attemptRects.begin(), m_attemptRects.end(), m_attemptRects.size()).failed;
+				}
+				catch (const RectangleTooLargeError&) {
+					succeeded = false;
+				}
+
+				if (succeeded && (std::uint64_t) width * height < m_bestArea) {
+					m_bestWidth = width;
+					m_bestHeight = height;
+					m_bestArea = (std::uint64_t) width * height;
+				}
+
+				return succeeded;
+			}
+
+			/**
+			 * Finds the first size in \p sizes with which the rectangles fit using binary search. It assumes that
+			 * larger sizes fit if a smaller one does. The largest size is tried first: once a size was found, most
+			 * widths can't reach a smaller area at all, so they are ruled out with a single attempt.
+			 */
+			template<typename Attempt>
+			void binarySearch(const std::vector<unsigned int>& sizes, Attempt attempt) {
+				if (sizes.empty() || !attempt(sizes.back()))
+					return;
+
+				auto low = std::size_t(0), high = sizes.size() - 1;
+
+				while (low < high) {
+					const auto middle = low + (high - low) / 2;
+
+					if (attempt(sizes[middle]))
+						high = middle;
+					else
+						low = middle + 1;
+				}
+			}
+
+			void searchSquare() {
+				const auto sides = getSizes(
+					std::max(m_minWidth, std::max(m_minHeight, m_minLongSide)),
+					std::min(m_search.maxWidth, m_search.maxHeight)
+				);
+
+				binarySearch(sides, [&](unsigned int side) {
+					return attempt(side, side);
+				});
+			}
+
+			/**
+			 * Tries every width in increasing order and searches the smallest height for it. The range of heights
+			 * shrinks with every size found, since only smaller areas are of interest.
+			 */
+			void searchRectangle() {
+				for (auto width : getSizes(m_minWidth, m_search.maxWidth)) {
+					// Heights only get smaller with increasing widths, so nothing better can come
+					if (m_bestArea != noArea && (std::uint64_t) width * std::max(1u, m_minHeight) >= m_bestArea)
+						break;
+
+					auto minHeight = (std::uint64_t) std::max(m_minHeight, width < m_minLongSide ? m_minLongSide : 0u);
+					minHeight = std::max(minHeight, (m_area + width - 1) / width);
+
+					auto maxHeight = (std::uint64_t) m_search.maxHeight;
+
+					if (m_bestArea != noArea)
+						maxHeight = std::min(maxHeight, (m_bestArea - 1) / width);
+
+					if (m_search.maxAspect > 0) {
+						minHeight = std::max(minHeight, (std::uint64_t) (width + m_search.maxAspect - 1) / m_search.maxAspect);
+						maxHeight = std::min(maxHeight, (std::uint64_t) width * m_search.maxAspect);
+					}
+
+					if (minHeight > maxHeight)
+						continue;
+
+					binarySearch(getSizes((unsigned int) minHeight, (unsigned int) maxHeight), [&](unsigned int height) {
+						return attempt(width, height);
+					});
+				}
+			}
+
+			Configuration& m_config;
+			const SizeSearchConfiguration& m_search;
+			Configuration m_attempt;
+			It m_begin;
+			ItEnd m_end;
+			std::size_t m_size;
+			std::vector<BinRect> m_rects;
+			std::vector<BinRect> m_attemptRects;
+			std::uint64_t m_area = 0;
+			unsigned int m_minWidth = 1;
+			unsigned int m_minHeight = 1;
+			unsigned int m_minLongSide = 1;
+			unsigned int m_bestWidth = 0;
+			unsigned int m_bestHeight = 0;
+			std::uint64_t m_bestArea = noArea;
+		};
+	}
+	/// \endcond
+
+	/**
+	 * \brief Packs rectangles into a single bin of the smallest size possible
+	 *
+	 * Searches the bin size with the smallest area which satisfies the constraints. Sizes below the area of all
+	 * rectangles or the size of the largest rectangle are skipped without packing. For every width the height is
+	 * determined by binary search, square bins use binary search on the side length. The width and height of
+	 * \p config are set to the size found, the rectangles are packed into it. If nothing fits, the maximum size is
+	 * used and the result is marked as failed. If a rectangle doesn't fit into the maximum size at all, every
+	 * rectangle is set to InvalidBin.
+	 *
+	 * Works with every configuration for which a packing function exists, e.g. MaxRectsConfiguration or
+	 * GuillotineConfiguration. The rectangles are always packed into a single bin, the number of bins of
+	 * \p config is left unchanged.
+	 *
+	 * \param config Configuration to use for packing. Its width and height are overwritten.
+	 * \param search Constraints for the bin size
+	 * \param begin Begin iterator of the sequence of rectangles
+	 * \param end End iterator of the sequence of rectangles
+	 * \param size Size of the sequence. Helps the internal vector reserve enough space, can be set to 0
+	 * \returns If the packing suceeded and the number of used bins
+	 */
+	template<typename Configuration, typename It, typename ItEnd>
+	Result packMinimumSize(Configuration& config, const SizeSearchConfiguration& search, It begin, ItEnd end, std::size_t size = 0) {
+		Internal::SizeSearch<Configuration, It, ItEnd> sizeSearch(config, search, begin, end, size);
+		return sizeSearch.pack();
+	}
+
+	/**
+	 * \brief Packs rectangles into a single bin of the smallest size possible
+	 *
+	 * Searches the bin size with the smallest area which satisfies the constraints. Sizes below the area of all
+	 * rectangles or the size of the largest rectangle are skipped without packing. For every width the height is
+	 * determined by binary search, square bins use binary search on the side length. The width and height of
+	 * \p config are set to the size found, the rectangles are packed into it. If nothing fits, the maximum size is
+	 * used and the result is marked as failed. If a rectangle doesn't fit into the maximum size at all, every
+	 * rectangle is set to InvalidBin.
+	 *
+	 * Works with every configuration for which a packing function exists, e.g. MaxRectsConfiguration or
+	 * GuillotineConfiguration. The rectangles are always packed into a single bin, the number of bins of
+	 * \p config is left unchanged.
+	 *
+	 * \param config Configuration to use for packing. Its width and height are overwritten.
+	 * \param search Constraints for the bin size
+	 * \param collection Collection of rectangles e.g. vector, list, array
+	 * \returns If the packing suceeded and the number of used bins
+	 */
+	template<typename Configuration, typename Collection>
+	Result packMinimumSize(Configuration& config, const SizeSearchConfiguration& search, Collection& collection) {
+		return packMinimumSize(config, search, std::begin(collection), std::end(collection), Internal::size(collection));
+	}
+
+	/**
+	 * @}
+	 */
+}
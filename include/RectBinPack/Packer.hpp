@@ -0,0 +1,469 @@
+/**
+ * \file Packer.hpp
+ * Packers which keep their bins between calls and can be saved and restored
+ */
+
+#pragma once
+
+#include "RectBinPack.hpp"
+#include "Guillotine.hpp"
+#include "MaxRects.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace RectBinPack {
+	/**
+	 * \addtogroup Packer
+	 * @{
+	 */
+
+	/// Exception thrown if a saved packer state can't be loaded
+	class PackerStateError: public std::runtime_error {
+	public:
+		/// Construct from message string
+		explicit PackerStateError(const char* msg):
+			std::runtime_error(msg) { }
+
+		/// Construct from message string
+		explicit PackerStateError(const std::string& msg):
+			std::runtime_error(msg) { }
+	};
+
+	/// \cond INTERNAL
+	namespace Internal {
+		/// Current version of the saved packer state
+		const std::uint32_t packerStateVersion = 1;
+
+		/// Writes values in little endian order
+		class StateWriter {
+		public:
+			/// Writes the header of the saved state
+			explicit StateWriter(char engine) {
+				m_data.insert(m_data.end(), { 'R', 'B', 'P', 'S' });
+				write(packerStateVersion);
+				write((std::uint32_t) engine);
+			}
+
+			/// Writes the bytes of \p value
+			template<typename T>
+			void write(T value) {
+				const auto bytes = (std::uint64_t) value;
+
+				for (auto i = 0u; i < sizeof(T) * 8; i += 8)
+					m_data.push_back((unsigned char) (bytes >> i));
+			}
+
+			/// Writes the number of rectangles followed by the rectangles
+			void write(const std::vector<Rect>& rects) {
+				write((std::uint32_t) rects.size());
+
+				for (auto& rect : rects) {
+					write(rect.x);
+					write(rect.y);
+					write(rect.width);
+					write(rect.height);
+				}
+			}
+
+			/// Returns the data written so far
+			std::vector<unsigned char>& data() {
+				return m_data;
+			}
+
+		private:
+			std::vector<unsigned char> m_data;
+		};
+
+		/// Reads values written by StateWriter
+		class StateReader {
+		public:
+			/**
+			 * \brief Reads the header of the saved state
+			 *
+			 * \throws PackerStateError if the header doesn't match
+			 */
+			StateReader(const void* data, std::size_t size, char engine):
+				m_data(static_cast<const unsigned char*>(data)), m_size(size) {
+
+				if (m_size < 4 || std::memcmp(m_data, "RBPS", 4) != 0)
+					throw PackerStateError("invalid magic number");
+
+				m_pos = 4;
+
+				if (read<std::uint32_t>() != packerStateVersion)
+					throw PackerStateError("unsupported version");
+
+				if (read<std::uint32_t>() != (std::uint32_t) engine)
+					throw PackerStateError("state was saved by a different packer");
+			}
+
+			/// Reads a value of type \p T
+			template<typename T>
+			T read() {
+				if (m_size - m_pos < sizeof(T))
+					throw PackerStateError("unexpected end of data");
+
+				std::uint64_t bytes = 0;
+
+				for (auto i = 0u; i < sizeof(T) * 8; i += 8)
+					bytes |= (std::uint64_t) m_data[m_pos++] << i;
+
+				return (T) bytes;
+			}
+
+			/**
+			 * \brief Reads a value of the enum \p T
+			 *
+			 * \param last Last value of the enum
+			 * \throws PackerStateError if the value is out of range
+			 */
+			template<typename T>
+			T readEnum(T last) {
+				const auto value = read<std::uint32_t>();
+
+				if (value > (std::uint32_t) last)
+					throw PackerStateError("invalid enum value");
+
+				return (T) value;
+			}
+
+			/**
+			 * \brief Reads rectangles which have to lie within a bin
+			 *
+			 * \throws PackerStateError if a rectangle is outside of \p width x \p height
+			 */
+			void read(std::vector<Rect>& rects, unsigned int width, unsigned int height) {
+				read(rects);
+
+				for (auto& rect : rects) {
+					if (rect.x > width || rect.width > width - rect.x || rect.y > height || rect.height > height - rect.y)
+						throw PackerStateError("rectangle outside of the bin");
+				}
+			}
+
+			/// Reads the number of rectangles followed by the rectangles
+			void read(std::vector<Rect>& rects) {
+				const auto count = read<std::uint32_t>();
+
+				if ((m_size - m_pos) / 16 < count)
+					throw PackerStateError("unexpected end of data");
+
+				rects.resize(count);
+
+				for (auto& rect : rects) {
+					rect.x = read<std::uint32_t>();
+					rect.y = read<std::uint32_t>();
+					rect.width = read<std::uint32_t>();
+					rect.height = read<std::uint32_t>();
+				}
+			}
+
+			/// Throws if there is data left
+			void finish() const {
+				if (m_pos != m_size)
+					throw PackerStateError("unexpected data after the end");
+			}
+
+		private:
+			const unsigned char* m_data;
+			std::size_t m_size;
+			std::size_t m_pos;
+		};
+	}
+	/// \endcond
+
+	/**
+	 * \brief Packs rectangles with the %MaxRects algorithm into bins which are kept between calls
+	 *
+	 * Every call to insert continues with the bins of the previous calls, so rectangles packed earlier never move.
+	 * The state can be saved into a binary blob and loaded again, e.g. to restore a texture cache on startup without
+	 * replaying all insertions.
+	 */
+	class MaxRectsPacker {
+	public:
+		/// Constructs the packer without any bins
+		explicit MaxRectsPacker(const MaxRectsConfiguration& config):
+			m_config(config), m_state() { }
+
+		/**
+		 * \brief Packs rectangles into the existing bins and adds bins if needed
+		 *
+		 * \param begin Begin iterator of the sequence of rectangles
+		 * \param end End iterator of the sequence of rectangles
+		 * \param size Size of the sequence. Helps the internal vector reserve enough space, can be set to 0
+		 * \returns If the packing suceeded and the number of used bins
+		 * \throws RectangleTooLargeError if the rectangle is too big to fit into any bin
+		 */
+		template<typename It, typename ItEnd>
+		Result insert(It begin, ItEnd end, std::size_t size = 0) {
+			Internal::MaxRects<It> maxRects(begin, end, size, m_config);
+			const auto succeeded = maxRects.pack(m_state);
+			return { !succeeded, numBins(), maxRects.peakMemory() };
+		}
+
+		/**
+		 * \brief Packs rectangles into the existing bins and adds bins if needed
+		 *
+		 * \param collection Collection of rectangles e.g. vector, list, array
+		 * \returns If the packing suceeded and the number of used bins
+		 * \throws RectangleTooLargeError if the rectangle is too big to fit into any bin
+		 */
+		template<typename Collection>
+		Result insert(Collection& collection) {
+			return insert(std::begin(collection), std::end(collection), Internal::size(collection));
+		}
+
+		/// Returns the number of bins used
+		unsigned int numBins() const {
+			return m_state.bins.size();
+		}
+
+		/// Returns the configuration
+		const MaxRectsConfiguration& configuration() const {
+			return m_config;
+		}
+
+		/// Removes all bins
+		void clear() {
+			m_state = {};
+		}
+
+		/// Saves the configuration and the bins into a binary blob
+		std::vector<unsigned char> save() const {
+			Internal::StateWriter writer('M');
+
+			writer.write(m_config.width);
+			writer.write(m_config.height);
+			writer.write(m_config.minBins);
+			writer.write(m_config.maxBins);
+			writer.write(m_config.canFlip);
+			writer.write((std::uint32_t) m_config.rectHeuristic);
+			writer.write(m_config.borderPadding);
+			writer.write(m_config.spacing);
+			writer.write(m_config.alignment);
+			writer.write(m_config.obstacles);
+			writer.write(m_config.candidateQueue);
+			writer.write(m_config.pruneInterval);
+			writer.write(m_config.pruneThreshold);
+			writer.write(m_config.maxFreeRects);
+			writer.write((std::uint32_t) m_config.eviction);
+			writer.write((std::uint32_t) m_config.binSelection);
+			writer.write(m_config.stopEarly);
+
+			writer.write(m_state.freeArea);
+			writer.write((std::uint32_t) m_state.bins.size());
+
+			for (auto& bin : m_state.bins) {
+				writer.write(bin.freeRects);
+				writer.write(bin.usedRects);
+			}
+
+			return std::move(writer.data());
+		}
+
+		/**
+		 * \brief Restores a packer saved with save
+		 *
+		 * \param data Pointer to the saved state
+		 * \param size Size of the saved state in bytes
+		 * \throws PackerStateError if the data isn't a valid state of a MaxRectsPacker
+		 */
+		static MaxRectsPacker load(const void* data, std::size_t size) {
+			Internal::StateReader reader(data, size, 'M');
+			MaxRectsConfiguration config {};
+
+			config.width = reader.read<std::uint32_t>();
+			config.height = reader.read<std::uint32_t>();
+			config.minBins = reader.read<std::int32_t>();
+			config.maxBins = reader.read<std::int32_t>();
+			config.canFlip = reader.read<bool>();
+			config.rectHeuristic = reader.readEnum(MaxRectsHeuristic::ContactPointRule);
+			config.borderPadding = reader.read<std::uint32_t>();
+			config.spacing = reader.read<std::uint32_t>();
+			config.alignment = reader.read<std::uint32_t>();
+			reader.read(config.obstacles);
+			config.candidateQueue = reader.read<bool>();
+			config.pruneInterval = reader.read<std::uint32_t>();
+			config.pruneThreshold = reader.read<std::uint32_t>();
+			config.maxFreeRects = reader.read<std::uint32_t>();
+			config.eviction = reader.readEnum(MaxRectsEviction::Thinnest);
+			config.binSelection = reader.readEnum(BinSelection::LastFit);
+			config.stopEarly = reader.read<bool>();
+
+			MaxRectsPacker packer(config);
+			packer.m_state.freeArea = reader.read<std::uint64_t>();
+			packer.m_state.bins.resize(reader.read<std::uint32_t>());
+
+			for (auto& bin : packer.m_state.bins) {
+				reader.read(bin.freeRects, config.width, config.height);
+				reader.read(bin.usedRects, config.width, config.height);
+				bin.updateBounds();
+			}
+
+			reader.finish();
+			return packer;
+		}
+
+		/**
+		 * \brief Restores a packer saved with save
+		 *
+		 * \param data Saved state
+		 * \throws PackerStateError if the data isn't a valid state of a MaxRectsPacker
+		 */
+		static MaxRectsPacker load(const std::vector<unsigned char>& data) {
+			return load(data.data(), data.size());
+		}
+
+	private:
+		MaxRectsConfiguration m_config;
+		Internal::MaxRectsState m_state;
+	};
+
+	/**
+	 * \brief Packs rectangles with the %Guillotine algorithm into bins which are kept between calls
+	 *
+	 * Every call to insert continues with the bins of the previous calls, so rectangles packed earlier never move.
+	 * The state can be saved into a binary blob and loaded again, e.g. to restore a texture cache on startup without
+	 * replaying all insertions.
+	 */
+	class GuillotinePacker {
+	public:
+		/// Constructs the packer without any bins
+		explicit GuillotinePacker(const GuillotineConfiguration& config):
+			m_config(config), m_state() { }
+
+		/**
+		 * \brief Packs rectangles into the existing bins and adds bins if needed
+		 *
+		 * \param begin Begin iterator of the sequence of rectangles
+		 * \param end End iterator of the sequence of rectangles
+		 * \param size Size of the sequence. Helps the internal vector reserve enough space, can be set to 0
+		 * \returns If the packing suceeded and the number of used bins
+		 * \throws RectangleTooLargeError if the rectangle is too big to fit into any bin
+		 */
+		template<typename It, typename ItEnd>
+		Result insert(It begin, ItEnd end, std::size_t size = 0) {
+			Internal::Guillotine<It> guillotine(begin, end, size, m_config);
+			const auto succeeded = guillotine.pack(m_state);
+			return { !succeeded, numBins(), guillotine.peakMemory() };
+		}
+
+		/**
+		 * \brief Packs rectangles into the existing bins and adds bins if needed
+		 *
+		 * \param collection Collection of rectangles e.g. vector, list, array
+		 * \returns If the packing suceeded and the number of used bins
+		 * \throws RectangleTooLargeError if the rectangle is too big to fit into any bin
+		 */
+		template<typename Collection>
+		Result insert(Collection& collection) {
+			return insert(std::begin(collection), std::end(collection), Internal::size(collection));
+		}
+
+		/// Returns the number of bins used
+		unsigned int numBins() const {
+			return m_state.bins.size();
+		}
+
+		/// Returns the configuration
+		const GuillotineConfiguration& configuration() const {
+			return m_config;
+		}
+
+		/// Removes all bins
+		void clear() {
+			m_state = {};
+		}
+
+		/// Saves the configuration and the bins into a binary blob
+		std::vector<unsigned char> save() const {
+			Internal::StateWriter writer('G');
+
+			writer.write(m_config.width);
+			writer.write(m_config.height);
+			writer.write(m_config.minBins);
+			writer.write(m_config.maxBins);
+			writer.write(m_config.canFlip);
+			writer.write(m_config.merge);
+			writer.write((std::uint32_t) m_config.rectHeuristic);
+			writer.write((std::uint32_t) m_config.splitHeuristic);
+			writer.write(m_config.borderPadding);
+			writer.write(m_config.spacing);
+			writer.write(m_config.alignment);
+			writer.write(m_config.obstacles);
+			writer.write((std::uint32_t) m_config.binSelection);
+			writer.write(m_config.sequential);
+			writer.write(m_config.stopEarly);
+
+			writer.write(m_state.freeArea);
+			writer.write((std::uint32_t) m_state.bins.size());
+
+			for (auto& bin : m_state.bins)
+				writer.write(bin.freeRects);
+
+			return std::move(writer.data());
+		}
+
+		/**
+		 * \brief Restores a packer saved with save
+		 *
+		 * \param data Pointer to the saved state
+		 * \param size Size of the saved state in bytes
+		 * \throws PackerStateError if the data isn't a valid state of a GuillotinePacker
+		 */
+		static GuillotinePacker load(const void* data, std::size_t size) {
+			Internal::StateReader reader(data, size, 'G');
+			GuillotineConfiguration config {};
+
+			config.width = reader.read<std::uint32_t>();
+			config.height = reader.read<std::uint32_t>();
+			config.minBins = reader.read<std::int32_t>();
+			config.maxBins = reader.read<std::int32_t>();
+			config.canFlip = reader.read<bool>();
+			config.merge = reader.read<bool>();
+			config.rectHeuristic = reader.readEnum(GuillotineRectHeuristic::WorstLongSideFit);
+			config.splitHeuristic = reader.readEnum(GuillotineSplitHeuristic::LongerAxis);
+			config.borderPadding = reader.read<std::uint32_t>();
+			config.spacing = reader.read<std::uint32_t>();
+			config.alignment = reader.read<std::uint32_t>();
+			reader.read(config.obstacles);
+			config.binSelection = reader.readEnum(BinSelection::LastFit);
+			config.sequential = reader.read<bool>();
+			config.stopEarly = reader.read<bool>();
+
+			GuillotinePacker packer(config);
+			packer.m_state.freeArea = reader.read<std::uint64_t>();
+			packer.m_state.bins.resize(reader.read<std::uint32_t>());
+
+			for (auto& bin : packer.m_state.bins) {
+				reader.read(bin.freeRects, config.width, config.height);
+				bin.updateBounds();
+				bin.reindex(config);
+			}
+
+			reader.finish();
+			return packer;
+		}
+
+		/**
+		 * \brief Restores a packer saved with save
+		 *
+		 * \param data Saved state
+		 * \throws PackerStateError if the data isn't a valid state of a GuillotinePacker
+		 */
+		static GuillotinePacker load(const std::vector<unsigned char>& data) {
+			return load(data.data(), data.size());
+		}
+
+	private:
+		GuillotineConfiguration m_config;
+		Internal::GuillotineState m_state;
+	};
+
+	/**
+	 * @}
+	 */
+}
@@ -5,8 +5,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 namespace RectBinPack {
 	/// Exception thrown by packing function when rectangle is larger then bin size
@@ -89,11 +93,20 @@ namespace RectBinPack {
 		/**
 		 * \brief Indicates if the algorithm failed to pack the bin with the supplied configuration.
 		 *
-		 * Unpacked rectangles are set to InvalidBin. Packed rectangles stay the same.
+		 * Unpacked rectangles are set to InvalidBin. Packed rectangles stay the same. With the stopEarly option,
+		 * packing stops as soon as the remaining rectangles can't fit into the last bin anymore.
 		 */
 		bool failed;
 
 		unsigned int numBins; ///< Number of bins used for packing
+
+		/**
+		 * \brief Approximate peak number of bytes used while packing
+		 *
+		 * Counts the bins, the rectangles left for packing and the lookup structures of the algorithm. Reported by
+		 * packMaxRects, packGuillotine, the packers and the repacking functions. 0 if not measured.
+		 */
+		std::size_t peakMemory;
 	};
 
 	/// Conversion function from CustomRect to Rect
@@ -112,6 +125,14 @@ namespace RectBinPack {
 	/// Indicates if no maximum should be used
 	const int UnlimitedBins = -1;
 
+	/// Policy for choosing the open bin the next rectangle is packed into
+	enum class BinSelection {
+		GlobalBest, ///< Search all open bins for the best placement
+		FirstFit,   ///< Use the first open bin where any rectangle fits
+		BestFit,    ///< Use the open bin with the smallest largest free space where any rectangle fits
+		LastFit     ///< Use the most recently opened bin where any rectangle fits
+	};
+
 	/// \cond INTERNAL
 	namespace Internal {
 		/// Swaps \p it with the back of the vector and pops its back
@@ -134,6 +155,331 @@ namespace RectBinPack {
 		std::size_t size(const T(&c)[N]) {
 			return N;
 		}
+
+		/// Returns the indices of the bins in the order they're searched with \p selection
+		template<typename Bin>
+		std::vector<std::size_t> getBinOrder(BinSelection selection, const std::vector<Bin>& bins) {
+			std::vector<std::size_t> order(bins.size());
+
+			for (std::size_t i = 0; i < order.size(); ++i)
+				order[i] = selection == BinSelection::LastFit ? order.size() - 1 - i : i;
+
+			if (selection == BinSelection::BestFit)
+				std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+					return bins[a].maxArea < bins[b].maxArea;
+				});
+
+			return order;
+		}
+
+		/**
+		 * \brief Maps rectangles into the packing area of a bin and back
+		 *
+		 * The packing area starts at the border padding rounded up to the alignment. Rectangles take up their size
+		 * plus the spacing rounded up to the alignment, so every position inside the packing area is aligned, too.
+		 * The packing area is extended by the spacing, since the last rectangle in a row doesn't need any.
+		 */
+		class Layout {
+		public:
+			/// Constructs the layout for a bin of the given size
+			Layout(unsigned int width, unsigned int height, unsigned int borderPadding, unsigned int spacing, unsigned int alignment):
+				m_spacing(spacing), m_alignment(std::max(1u, alignment)) {
+
+				m_origin = alignUp(borderPadding);
+				m_width = getInnerSize(width, borderPadding);
+				m_height = getInnerSize(height, borderPadding);
+			}
+
+			/// Returns the width of the packing area
+			unsigned int width() const {
+				return m_width;
+			}
+
+			/// Returns the height of the packing area
+			unsigned int height() const {
+				return m_height;
+			}
+
+			/// Returns the size which \p rect takes up inside the packing area
+			Rect inflate(const Rect& rect) const {
+				return { 0, 0, alignUp(rect.width + m_spacing), alignUp(rect.height + m_spacing) };
+			}
+
+			/// Returns the position of \p rect in the bin, when its space was placed at \p occupied
+			Rect place(const Rect& occupied, const Rect& rect, bool flip) const {
+				return {
+					m_origin + occupied.x,
+					m_origin + occupied.y,
+					flip ? rect.height : rect.width,
+					flip ? rect.width : rect.height
+				};
+			}
+
+			/**
+			 * \brief Finds the space which \p rect takes up when it's positioned at \p placed in the bin
+			 *
+			 * \returns false, if the position isn't aligned or the space lies outside of the packing area
+			 */
+			bool unplace(const Rect& placed, const Rect& rect, bool flip, Rect& occupied) const {
+				if (placed.x < m_origin || placed.y < m_origin)
+					return false;
+
+				const auto size = inflate(rect);
+
+				occupied = {
+					placed.x - m_origin,
+					placed.y - m_origin,
+					flip ? size.height : size.width,
+					flip ? size.width : size.height
+				};
+
+				if (occupied.x % m_alignment != 0 || occupied.y % m_alignment != 0)
+					return false;
+
+				return occupied.width <= m_width && occupied.x <= m_width - occupied.width &&
+					occupied.height <= m_height && occupied.y <= m_height - occupied.height;
+			}
+
+			/**
+			 * \brief Finds the space in the packing area which \p obstacle blocks
+			 *
+			 * The space includes the spacing after the obstacle and is extended to the alignment, so rectangles
+			 * next to it keep their distance.
+			 *
+			 * \returns false, if the obstacle doesn't touch the packing area
+			 */
+			bool block(const Rect& obstacle, Rect& blocked) const {
+				if (obstacle.width == 0 || obstacle.height == 0)
+					return false;
+
+				const auto left = std::max((long long) obstacle.x - m_origin, 0ll) / m_alignment * m_alignment;
+				const auto top = std::max((long long) obstacle.y - m_origin, 0ll) / m_alignment * m_alignment;
+
+				const auto right = std::min(
+					((long long) obstacle.x + obstacle.width + m_spacing - m_origin + m_alignment - 1) / m_alignment * m_alignment,
+					(long long) m_width
+				);
+
+				const auto bottom = std::min(
+					((long long) obstacle.y + obstacle.height + m_spacing - m_origin + m_alignment - 1) / m_alignment * m_alignment,
+					(long long) m_height
+				);
+
+				if (right <= left || bottom <= top)
+					return false;
+
+				blocked = {
+					(unsigned int) left, (unsigned int) top, (unsigned int) (right - left), (unsigned int) (bottom - top)
+				};
+
+				return true;
+			}
+
+		private:
+			unsigned int alignUp(unsigned int value) const {
+				return (value + m_alignment - 1) / m_alignment * m_alignment;
+			}
+
+			unsigned int getInnerSize(unsigned int size, unsigned int borderPadding) const {
+				if ((unsigned long long) m_origin + borderPadding >= (unsigned long long) size + m_spacing)
+					return 0;
+
+				const auto inner = size + m_spacing - m_origin - borderPadding;
+				return inner / m_alignment * m_alignment;
+			}
+
+			unsigned int m_origin;
+			unsigned int m_width;
+			unsigned int m_height;
+			unsigned int m_spacing;
+			unsigned int m_alignment;
+		};
+
+		/**
+		 * \brief Rectangles left for packing, grouped by the space they take up
+		 *
+		 * Rectangles of the same size always get the same score, so every group only has to be scored once. Groups
+		 * keep their index while packing, the active list contains the groups which still have rectangles left.
+		 */
+		template<typename It>
+		class RectGroups {
+		public:
+			/// Rectangles of the same size
+			struct Group {
+				Rect size; ///< Space the rectangles take up in the bin
+				std::vector<It> rects; ///< Rectangles in input order
+				std::size_t next; ///< Index of the first rectangle which isn't packed yet
+
+				/// Returns the number of rectangles left
+				std::size_t count() const {
+					return rects.size() - next;
+				}
+			};
+
+			/// Reserves room for looking up \p size groups
+			void reserve(std::size_t size) {
+				m_lookup.reserve(size);
+			}
+
+			/// Adds \p it to the group of \p size and returns the index of the group
+			std::size_t add(It it, const Rect& size) {
+				const auto key = ((std::uint64_t) size.width << 32) | size.height;
+				auto found = m_lookup.find(key);
+
+				if (found == m_lookup.end()) {
+					found = m_lookup.emplace(key, m_groups.size()).first;
+					m_active.push_back(m_groups.size());
+					m_groups.push_back({ size, {}, 0 });
+				}
+
+				m_groups[found->second].rects.push_back(it);
+				++m_size;
+				return found->second;
+			}
+
+			/// Removes the first rectangle left in the group and returns it
+			It take(std::size_t group) {
+				auto& entry = m_groups[group];
+				const auto it = entry.rects[entry.next++];
+
+				if (entry.next == entry.rects.size())
+					m_active.erase(std::find(m_active.begin(), m_active.end(), group));
+
+				--m_size;
+				return it;
+			}
+
+			/**
+			 * \brief Looks up the group of rectangles with the given size
+			 *
+			 * \returns true, if the group exists and has rectangles left
+			 */
+			bool find(unsigned int width, unsigned int height, std::size_t& group) const {
+				const auto found = m_lookup.find(((std::uint64_t) width << 32) | height);
+
+				if (found == m_lookup.end() || m_groups[found->second].count() == 0)
+					return false;
+
+				group = found->second;
+				return true;
+			}
+
+			/// Returns the group at \p group
+			const Group& operator[](std::size_t group) const {
+				return m_groups[group];
+			}
+
+			/// Returns the indices of the groups which have rectangles left, in the order they were created
+			const std::vector<std::size_t>& active() const {
+				return m_active;
+			}
+
+			/// Returns the number of groups ever created
+			std::size_t numGroups() const {
+				return m_groups.size();
+			}
+
+			/// Returns the number of rectangles left
+			std::size_t size() const {
+				return m_size;
+			}
+
+			/// Returns true if no rectangles are left
+			bool empty() const {
+				return m_size == 0;
+			}
+
+			/// Returns the approximate number of bytes allocated by the groups
+			std::size_t memoryUsage() const {
+				const auto nodeSize = sizeof(std::pair<const std::uint64_t, std::size_t>) + sizeof(void*);
+
+				auto memory = m_groups.capacity() * sizeof(Group) + m_active.capacity() * sizeof(std::size_t) +
+					m_lookup.size() * nodeSize + m_lookup.bucket_count() * sizeof(void*);
+
+				for (auto& group : m_groups)
+					memory += group.rects.capacity() * sizeof(It);
+
+				return memory;
+			}
+
+			/// Calls \p function for every rectangle left
+			template<typename Function>
+			void forEach(Function function) const {
+				for (auto group : m_active)
+					for (auto i = m_groups[group].next; i < m_groups[group].rects.size(); ++i)
+						function(m_groups[group].rects[i]);
+			}
+
+		private:
+			std::vector<Group> m_groups;
+			std::vector<std::size_t> m_active;
+			std::unordered_map<std::uint64_t, std::size_t> m_lookup;
+			std::size_t m_size = 0;
+		};
+
+		/// Returns the area covered by the rectangles, counting overlapping parts once
+		inline std::uint64_t getUnionArea(const std::vector<Rect>& rects) {
+			std::vector<unsigned int> xs;
+
+			for (auto& rect : rects) {
+				xs.push_back(rect.left());
+				xs.push_back(rect.right());
+			}
+
+			std::sort(xs.begin(), xs.end());
+			xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+
+			std::uint64_t area = 0;
+
+			// Sum up the covered height of every vertical slice between two edges
+			for (std::size_t i = 0; i + 1 < xs.size(); ++i) {
+				std::vector<std::pair<unsigned int, unsigned int>> spans;
+
+				for (auto& rect : rects)
+					if (rect.left() <= xs[i] && rect.right() >= xs[i + 1])
+						spans.emplace_back(rect.top(), rect.bottom());
+
+				std::sort(spans.begin(), spans.end());
+
+				std::uint64_t height = 0;
+				auto end = 0u;
+
+				for (auto& span : spans) {
+					if (span.second <= end)
+						continue;
+
+					height += span.second - std::max(span.first, end);
+					end = span.second;
+				}
+
+				area += height * (xs[i + 1] - xs[i]);
+			}
+
+			return area;
+		}
+
+		/// Incremental 64 bit FNV-1a hash
+		class Hasher {
+		public:
+			/// Adds the bytes of \p value in little endian order
+			template<typename T>
+			void add(T value) {
+				const auto bytes = (std::uint64_t) value;
+
+				for (auto i = 0u; i < 64; i += 8) {
+					m_hash ^= (bytes >> i) & 0xFF;
+					m_hash *= 1099511628211ull;
+				}
+			}
+
+			/// Returns the hash of everything added so far
+			std::uint64_t value() const {
+				return m_hash;
+			}
+
+		private:
+			std::uint64_t m_hash = 14695981039346656037ull;
+		};
 	}
 	/// \endcond
 }
@@ -0,0 +1,210 @@
+/**
+ * \file Repack.hpp
+ * Repacking which keeps the placements of a previous layout
+ */
+
+#pragma once
+
+#include "RectBinPack.hpp"
+#include "Guillotine.hpp"
+#include "MaxRects.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace RectBinPack {
+	/**
+	 * \addtogroup Repack
+	 * @{
+	 */
+
+	/// \cond INTERNAL
+	namespace Internal {
+		/**
+		 * \brief Keeps every valid hint fixed and packs the other rectangles into the remaining space
+		 *
+		 * A hint is valid if it has a bin, matches the size of the rectangle, lies inside the packing area and
+		 * doesn't overlap a hint kept before. Falls back to packing all rectangles if the rest doesn't fit. The
+		 * previous layout can't have used more bins than there are rectangles or the minimum number of bins, so
+		 * hints beyond that are stale.
+		 *
+		 * \tparam Engine Implementation of the algorithm, working on BinRect vectors
+		 * \tparam State Bins of the algorithm
+		 */
+		template<typename Engine, typename State, typename Configuration, typename It, typename ItEnd, typename HintIt>
+		Result repack(const Configuration& config, It begin, ItEnd end, HintIt hints, std::size_t size) {
+			const Layout layout(config.width, config.height, config.borderPadding, config.spacing, config.alignment);
+
+			std::vector<It> kept, pending;
+			std::vector<BinRect> keptRects, pendingRects;
+
+			kept.reserve(size);
+			keptRects.reserve(size);
+
+			State state {};
+			std::size_t count = 0;
+
+			for (auto it = begin; it != end; ++it)
+				++count;
+
+			const auto binLimit = std::max(count, (std::size_t) std::max(1, config.minBins));
+
+			{
+				std::vector<BinRect> none;
+				Engine fixed(none.begin(), none.end(), 0, config);
+
+				for (auto it = begin; it != end; ++it, ++hints) {
+					const auto rect = toRect(*it);
+					const BinRect& hint = *hints;
+
+					if (rect.width == 0 || rect.height == 0) {
+						pending.push_back(it);
+						pendingRects.push_back({ { 0, 0, 0, 0 }, InvalidBin, false });
+						continue;
+					}
+
+					const auto expected = hint.flipped ? rect.flipped() : rect;
+					Rect occupied;
+
+					const auto isValid =
+						hint.bin != InvalidBin && hint.bin < binLimit &&
+						(config.maxBins < 1 || hint.bin < (unsigned int) config.maxBins) &&
+						(config.canFlip || !hint.flipped) &&
+						hint.rect.width == expected.width && hint.rect.height == expected.height &&
+						layout.unplace(hint.rect, rect, hint.flipped, occupied) &&
+						fixed.occupy(state, hint.bin, occupied);
+
+					if (isValid) {
+						kept.push_back(it);
+						keptRects.push_back(hint);
+					}
+					else {
+						pending.push_back(it);
+						pendingRects.push_back({ { 0, 0, rect.width, rect.height }, InvalidBin, false });
+					}
+				}
+			}
+
+			Engine engine(pendingRects.begin(), pendingRects.end(), pendingRects.size(), config);
+
+			// Nothing is written before, so the rectangles can still be packed from scratch
+			if (!engine.pack(state))
+				return Internal::pack(config, begin, end, size);
+
+			for (std::size_t i = 0; i < kept.size(); ++i)
+				fromBinRect(*kept[i], keptRects[i]);
+
+			for (std::size_t i = 0; i < pending.size(); ++i)
+				fromBinRect(*pending[i], pendingRects[i]);
+
+			return { false, (unsigned int) state.bins.size(), engine.peakMemory() };
+		}
+	}
+	/// \endcond
+
+	/**
+	 * \brief Packs rectangles using the %MaxRects algorithm and keeps the placements of a previous layout
+	 *
+	 * Every rectangle has a hint, which is its placement in the previous layout. Hints of rectangles whose size
+	 * didn't change are kept fixed, as long as they still fit into the bins and don't overlap. The other rectangles,
+	 * e.g. new ones or ones with InvalidBin, are packed into the remaining space. If they don't fit, all rectangles
+	 * are packed from scratch.
+	 *
+	 * The sizes are taken from the rectangles, not from the hints. Rectangles which were flipped in the previous
+	 * layout need to have their original size.
+	 *
+	 * \param config Configuration to use for packing
+	 * \param begin Begin iterator of the sequence of rectangles
+	 * \param end End iterator of the sequence of rectangles
+	 * \param hints Iterator to the first previous placement (BinRect) matching \p begin
+	 * \param size Size of the sequence. Helps the internal vector reserve enough space, can be set to 0
+	 * \returns If the packing suceeded and the number of used bins
+	 * \throws RectangleTooLargeError if the rectangle is too big to fit into any bin
+	 */
+	template<typename It, typename ItEnd, typename HintIt>
+	Result repackMaxRects(const MaxRectsConfiguration& config, It begin, ItEnd end, HintIt hints, std::size_t size = 0) {
+		using Engine = Internal::MaxRects<std::vector<BinRect>::iterator>;
+		return Internal::repack<Engine, Internal::MaxRectsState>(config, begin, end, hints, size);
+	}
+
+	/**
+	 * \brief Packs rectangles using the %MaxRects algorithm and keeps the placements of a previous layout
+	 *
+	 * Every rectangle has a hint, which is its placement in the previous layout. Hints of rectangles whose size
+	 * didn't change are kept fixed, as long as they still fit into the bins and don't overlap. The other rectangles,
+	 * e.g. new ones or ones with InvalidBin, are packed into the remaining space. If they don't fit, all rectangles
+	 * are packed from scratch.
+	 *
+	 * The sizes are taken from the rectangles, not from the hints. Rectangles which were flipped in the previous
+	 * layout need to have their original size.
+	 *
+	 * \param config Configuration to use for packing
+	 * \param collection Collection of rectangles e.g. vector, list, array
+	 * \param hints Collection of previous placements (BinRect) in the same order as \p collection
+	 * \returns If the packing suceeded and the number of used bins
+	 * \throws RectangleTooLargeError if the rectangle is too big to fit into any bin
+	 * \throws std::invalid_argument if the collections differ in size
+	 */
+	template<typename Collection, typename HintCollection>
+	Result repackMaxRects(const MaxRectsConfiguration& config, Collection& collection, const HintCollection& hints) {
+		if (Internal::size(collection) != Internal::size(hints))
+			throw std::invalid_argument("number of rectangles and hints differ");
+
+		return repackMaxRects(config, std::begin(collection), std::end(collection), std::begin(hints), Internal::size(collection));
+	}
+
+	/**
+	 * \brief Packs rectangles using the %Guillotine algorithm and keeps the placements of a previous layout
+	 *
+	 * Every rectangle has a hint, which is its placement in the previous layout. Hints of rectangles whose size
+	 * didn't change are kept fixed, as long as they still fit into the bins and don't overlap. The other rectangles,
+	 * e.g. new ones or ones with InvalidBin, are packed into the remaining space. If they don't fit, all rectangles
+	 * are packed from scratch.
+	 *
+	 * The sizes are taken from the rectangles, not from the hints. Rectangles which were flipped in the previous
+	 * layout need to have their original size.
+	 *
+	 * \param config Configuration to use for packing
+	 * \param begin Begin iterator of the sequence of rectangles
+	 * \param end End iterator of the sequence of rectangles
+	 * \param hints Iterator to the first previous placement (BinRect) matching \p begin
+	 * \param size Size of the sequence. Helps the internal vector reserve enough space, can be set to 0
+	 * \returns If the packing suceeded and the number of used bins
+	 * \throws RectangleTooLargeError if the rectangle is too big to fit into any bin
+	 */
+	template<typename It, typename ItEnd, typename HintIt>
+	Result repackGuillotine(const GuillotineConfiguration& config, It begin, ItEnd end, HintIt hints, std::size_t size = 0) {
+		using Engine = Internal::Guillotine<std::vector<BinRect>::iterator>;
+		return Internal::repack<Engine, Internal::GuillotineState>(config, begin, end, hints, size);
+	}
+
+	/**
+	 * \brief Packs rectangles using the %Guillotine algorithm and keeps the placements of a previous layout
+	 *
+	 * Every rectangle has a hint, which is its placement in the previous layout. Hints of rectangles whose size
+	 * didn't change are kept fixed, as long as they still fit into the bins and don't overlap. The other rectangles,
+	 * e.g. new ones or ones with InvalidBin, are packed into the remaining space. If they don't fit, all rectangles
+	 * are packed from scratch.
+	 *
+	 * The sizes are taken from the rectangles, not from the hints. Rectangles which were flipped in the previous
+	 * layout need to have their original size.
+	 *
+	 * \param config Configuration to use for packing
+	 * \param collection Collection of rectangles e.g. vector, list, array
+	 * \param hints Collection of previous placements (BinRect) in the same order as \p collection
+	 * \returns If the packing suceeded and the number of used bins
+	 * \throws RectangleTooLargeError if the rectangle is too big to fit into any bin
+	 * \throws std::invalid_argument if the collections differ in size
+	 */
+	template<typename Collection, typename HintCollection>
+	Result repackGuillotine(const GuillotineConfiguration& config, Collection& collection, const HintCollection& hints) {
+		if (Internal::size(collection) != Internal::size(hints))
+			throw std::invalid_argument("number of rectangles and hints differ");
+
+		return repackGuillotine(config, std::begin(collection), std::end(collection), std::begin(hints), Internal::size(collection));
+	}
+
+	/**
+	 * @}
+	 */
+}
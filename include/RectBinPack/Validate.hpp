@@ -0,0 +1,237 @@
+/**
+ * \file Validate.hpp
+ * Checks packing results for overlaps, bounds and consistency
+ */
+
+#pragma once
+
+#include "RectBinPack.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <tuple>
+#include <vector>
+
+namespace RectBinPack {
+	/**
+	 * \addtogroup Validate
+	 * @{
+	 */
+
+	/// Problem found by validatePacking and validatePackingAgainst
+	enum class ValidationError {
+		None, ///< The packing is valid
+		NotPacked, ///< A rectangle has InvalidBin although the packing didn't fail
+		BinOutOfRange, ///< The bin of a rectangle is not below the number of bins
+		OutOfBounds, ///< A rectangle reaches outside of the bin
+		SizeMismatch, ///< The size doesn't match the original rectangle, taking flipping into account
+		Overlap ///< Two rectangles in the same bin overlap
+	};
+
+	/// Contains the first problem found by validatePacking and validatePackingAgainst
+	struct ValidationResult {
+		ValidationError error; ///< Kind of the problem
+		std::size_t index; ///< Index of the rectangle with the problem
+		std::size_t other; ///< Index of the second rectangle for ValidationError::Overlap
+
+		/// Returns true if the packing is valid
+		explicit operator bool() const {
+			return error == ValidationError::None;
+		}
+	};
+
+	/// \cond INTERNAL
+	namespace Internal {
+		/**
+		 * \brief Finds overlapping rectangles with a sweep line
+		 *
+		 * The rectangles of every bin are sorted by their left side. While sweeping from left to right, the
+		 * rectangles crossing the sweep line are kept ordered by their top side. They never overlap vertically if
+		 * the packing is valid, so comparing a new rectangle with its neighbors is enough.
+		 */
+		inline ValidationResult findOverlap(const std::vector<BinRect>& rects) {
+			std::vector<std::size_t> byLeft, byRight;
+
+			for (std::size_t i = 0; i < rects.size(); ++i)
+				if (rects[i].bin != InvalidBin && rects[i].rect.width > 0 && rects[i].rect.height > 0)
+					byLeft.push_back(i);
+
+			byRight = byLeft;
+
+			std::sort(byLeft.begin(), byLeft.end(), [&](std::size_t a, std::size_t b) {
+				return std::make_tuple(rects[a].bin, rects[a].rect.left()) < std::make_tuple(rects[b].bin, rects[b].rect.left());
+			});
+
+			std::sort(byRight.begin(), byRight.end(), [&](std::size_t a, std::size_t b) {
+				return std::make_tuple(rects[a].bin, rects[a].rect.right()) < std::make_tuple(rects[b].bin, rects[b].rect.right());
+			});
+
+			// Rectangles crossing the sweep line as top, bottom and index
+			std::set<std::tuple<unsigned int, unsigned int, std::size_t>> active;
+			std::size_t removed = 0;
+
+			for (std::size_t i = 0; i < byLeft.size(); ++i) {
+				const auto& current = rects[byLeft[i]];
+
+				if (i > 0 && rects[byLeft[i - 1]].bin != current.bin) {
+					active.clear();
+
+					while (rects[byRight[removed]].bin != current.bin)
+						++removed;
+				}
+
+				// Rectangles ending before the sweep line are left behind
+				while (removed < byRight.size() && rects[byRight[removed]].bin == current.bin && rects[byRight[removed]].rect.right() <= current.rect.left()) {
+					const auto& rect = rects[byRight[removed]].rect;
+					active.erase(std::make_tuple(rect.top(), rect.bottom(), byRight[removed]));
+					++removed;
+				}
+
+				const auto it = active.insert(std::make_tuple(current.rect.top(), current.rect.bottom(), byLeft[i])).first;
+
+				if (it != active.begin()) {
+					const auto previous = std::prev(it);
+
+					if (std::get<1>(*previous) > current.rect.top())
+						return { ValidationError::Overlap, std::get<2>(*previous), byLeft[i] };
+				}
+
+				const auto next = std::next(it);
+
+				if (next != active.end() && std::get<0>(*next) < current.rect.bottom())
+					return { ValidationError::Overlap, byLeft[i], std::get<2>(*next) };
+			}
+
+			return { ValidationError::None, 0, 0 };
+		}
+
+		/// Checks everything except the original sizes
+		template<typename It, typename ItEnd>
+		ValidationResult validate(const Result& result, unsigned int width, unsigned int height, It begin, ItEnd end, std::vector<BinRect>& rects) {
+			for (auto it = begin; it != end; ++it) {
+				const BinRect& rect = *it;
+				const auto index = rects.size();
+
+				rects.push_back(rect);
+
+				if (rect.bin == InvalidBin) {
+					if (!result.failed && rect.rect.width > 0 && rect.rect.height > 0)
+						return { ValidationError::NotPacked, index, 0 };
+
+					continue;
+				}
+
+				if (rect.bin >= result.numBins)
+					return { ValidationError::BinOutOfRange, index, 0 };
+
+				if ((std::uint64_t) rect.rect.x + rect.rect.width > width || (std::uint64_t) rect.rect.y + rect.rect.height > height)
+					return { ValidationError::OutOfBounds, index, 0 };
+			}
+
+			return findOverlap(rects);
+		}
+	}
+	/// \endcond
+
+	/**
+	 * \brief Checks a packing result
+	 *
+	 * Checks that every rectangle is packed unless the packing failed, that the bins are in range, that the
+	 * rectangles lie inside their bins and that no two rectangles of the same bin overlap. Overlaps are found with a
+	 * sweep line in O(n log n). Empty rectangles are ignored.
+	 *
+	 * \param result Result of the packing function
+	 * \param width Width of the bins
+	 * \param height Height of the bins
+	 * \param begin Begin iterator of the sequence of packed rectangles (BinRect)
+	 * \param end End iterator of the sequence of packed rectangles (BinRect)
+	 * \returns The first problem found, or ValidationError::None
+	 */
+	template<typename It, typename ItEnd>
+	ValidationResult validatePacking(const Result& result, unsigned int width, unsigned int height, It begin, ItEnd end) {
+		std::vector<BinRect> rects;
+		return Internal::validate(result, width, height, begin, end, rects);
+	}
+
+	/**
+	 * \brief Checks a packing result against the original rectangles
+	 *
+	 * Checks that every rectangle is packed unless the packing failed, that the bins are in range, that the
+	 * rectangles lie inside their bins and that no two rectangles of the same bin overlap. Overlaps are found with a
+	 * sweep line in O(n log n). Empty rectangles are ignored.
+	 *
+	 * Additionally the size of every packed rectangle has to match the original one, swapped if it was flipped.
+	 *
+	 * \param result Result of the packing function
+	 * \param width Width of the bins
+	 * \param height Height of the bins
+	 * \param begin Begin iterator of the sequence of packed rectangles (BinRect)
+	 * \param end End iterator of the sequence of packed rectangles (BinRect)
+	 * \param originals Iterator to the first original rectangle matching \p begin. It's converted with toRect.
+	 * \returns The first problem found, or ValidationError::None
+	 */
+	template<typename It, typename ItEnd, typename OriginalIt>
+	ValidationResult validatePackingAgainst(const Result& result, unsigned int width, unsigned int height, It begin, ItEnd end, OriginalIt originals) {
+		std::vector<BinRect> rects;
+		std::size_t index = 0;
+
+		for (auto it = begin; it != end; ++it, ++originals, ++index) {
+			const BinRect& rect = *it;
+			const auto original = toRect(*originals);
+			const auto expected = rect.flipped ? original.flipped() : original;
+
+			if (rect.bin != InvalidBin && (rect.rect.width != expected.width || rect.rect.height != expected.height))
+				return { ValidationError::SizeMismatch, index, 0 };
+		}
+
+		return Internal::validate(result, width, height, begin, end, rects);
+	}
+
+	/**
+	 * \brief Checks a packing result
+	 *
+	 * Checks that every rectangle is packed unless the packing failed, that the bins are in range, that the
+	 * rectangles lie inside their bins and that no two rectangles of the same bin overlap. Overlaps are found with a
+	 * sweep line in O(n log n). Empty rectangles are ignored.
+	 *
+	 * \param result Result of the packing function
+	 * \param width Width of the bins
+	 * \param height Height of the bins
+	 * \param collection Collection of packed rectangles (BinRect) e.g. vector, list, array
+	 * \returns The first problem found, or ValidationError::None
+	 */
+	template<typename Collection>
+	ValidationResult validatePacking(const Result& result, unsigned int width, unsigned int height, const Collection& collection) {
+		return validatePacking(result, width, height, std::begin(collection), std::end(collection));
+	}
+
+	/**
+	 * \brief Checks a packing result against the original rectangles
+	 *
+	 * Checks that every rectangle is packed unless the packing failed, that the bins are in range, that the
+	 * rectangles lie inside their bins and that no two rectangles of the same bin overlap. Overlaps are found with a
+	 * sweep line in O(n log n). Empty rectangles are ignored.
+	 *
+	 * Additionally the size of every packed rectangle has to match the original one, swapped if it was flipped.
+	 *
+	 * \param result Result of the packing function
+	 * \param width Width of the bins
+	 * \param height Height of the bins
+	 * \param collection Collection of packed rectangles (BinRect) e.g. vector, list, array
+	 * \param originals Collection of the original rectangles in the same order as \p collection
+	 * \returns The first problem found, or ValidationError::None
+	 * \throws std::invalid_argument if the collections differ in size
+	 */
+	template<typename Collection, typename OriginalCollection>
+	ValidationResult validatePackingAgainst(const Result& result, unsigned int width, unsigned int height, const Collection& collection, const OriginalCollection& originals) {
+		if (Internal::size(collection) != Internal::size(originals))
+			throw std::invalid_argument("number of rectangles and original rectangles differ");
+
+		return validatePackingAgainst(result, width, height, std::begin(collection), std::end(collection), std::begin(originals));
+	}
+
+	/**
+	 * @}
+	 */
+}
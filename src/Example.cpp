@@ -43,10 +43,14 @@ int main() {
 	for (unsigned int i = 0; i < numRects; ++i)
 		data.push_back({ 0, 0, getSize(rand()), getSize(rand()), true });
 
-	// Initialize configuration (size x size, 1 bin, no flipping, BestAreaFit)
-	RectBinPack::MaxRectsConfiguration config {
-		size, size, 1, 1, false, RectBinPack::MaxRectsHeuristic::BestAreaFit
-	};
+	// Initialize configuration (size x size, 1 bin, no flipping, BestAreaFit), every other option keeps its default
+	RectBinPack::MaxRectsConfiguration config {};
+	config.width = size;
+	config.height = size;
+	config.minBins = 1;
+	config.maxBins = 1;
+	config.canFlip = false;
+	config.rectHeuristic = RectBinPack::MaxRectsHeuristic::BestAreaFit;
 
 	// Pack rectangles
 	const auto result = RectBinPack::packMaxRects(config, data);
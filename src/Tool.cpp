@@ -0,0 +1,761 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <RectBinPack/Exact.hpp>
+#include <RectBinPack/Guillotine.hpp>
+#include <RectBinPack/MaxRects.hpp>
+
+enum class Engine { MaxRects, Guillotine, Exact };
+enum class Format { Csv, Json };
+
+struct Options {
+	Engine engine = Engine::MaxRects;
+	Format outputFormat = Format::Csv;
+	std::string input = "-";
+	std::string output = "-";
+	unsigned int width = 1024;
+	unsigned int height = 1024;
+	int minBins = 1;
+	int maxBins = RectBinPack::UnlimitedBins;
+	bool canFlip = false;
+	bool merge = false;
+	bool sequential = false;
+	bool stopEarly = false;
+	bool candidateQueue = false;
+	unsigned int pruneInterval = 0;
+	unsigned int pruneThreshold = 0;
+	unsigned int maxFreeRects = 0;
+	RectBinPack::MaxRectsEviction eviction = RectBinPack::MaxRectsEviction::SmallestArea;
+	RectBinPack::BinSelection binSelection = RectBinPack::BinSelection::GlobalBest;
+	unsigned int borderPadding = 0;
+	unsigned int spacing = 0;
+	unsigned int alignment = 0;
+	std::vector<RectBinPack::Rect> obstacles;
+	unsigned long nodeLimit = 0;
+	unsigned int timeLimit = 0;
+	RectBinPack::MaxRectsHeuristic maxRectsHeuristic = RectBinPack::MaxRectsHeuristic::BestShortSideFit;
+	RectBinPack::GuillotineRectHeuristic guillotineHeuristic = RectBinPack::GuillotineRectHeuristic::BestAreaFit;
+	RectBinPack::GuillotineSplitHeuristic splitHeuristic = RectBinPack::GuillotineSplitHeuristic::MinimizeArea;
+	bool help = false;
+};
+
+struct Item {
+	std::string name;
+	RectBinPack::BinRect rect;
+};
+
+// Conversion function from Item to Rect
+inline RectBinPack::Rect toRect(const Item& value) {
+	return value.rect.rect;
+}
+
+// Conversion function from BinRect to Item
+inline void fromBinRect(Item& value, RectBinPack::BinRect rect) {
+	value.rect = rect;
+}
+
+class UsageError: public std::runtime_error {
+public:
+	explicit UsageError(const std::string& msg):
+		std::runtime_error(msg) { }
+};
+
+static const char* usage =
+	"Usage: rectbinpack [options] [input]\n"
+	"\n"
+	"Reads rectangles from input (or stdin if missing or -), one per line. Lines are either\n"
+	"CSV (\"width,height\" or \"name,width,height\") or JSON objects with the keys name, width\n"
+	"and height. CSV names containing commas or quotes are put in double quotes. Empty lines\n"
+	"and lines starting with # are skipped. Writes one placement per rectangle in input order.\n"
+	"\n"
+	"Options:\n"
+	"  -o, --output FILE         Write placements to FILE instead of stdout\n"
+	"  -f, --format csv|json     Output format (default: csv)\n"
+	"  -e, --engine NAME         maxrects, guillotine or exact (default: maxrects)\n"
+	"  -w, --width N             Width of the bins (default: 1024)\n"
+	"  -h, --height N            Height of the bins (default: 1024)\n"
+	"      --min-bins N          Minimum number of bins (default: 1)\n"
+	"      --max-bins N          Maximum number of bins (default: unlimited)\n"
+	"      --flip                Allow flipping of rectangles\n"
+	"      --merge               Merge free rectangles (guillotine)\n"
+	"      --sequential          Pack the rectangles in input order (guillotine)\n"
+	"      --stop-early          Give up once the rest can't fit into the last bin (maxrects, guillotine)\n"
+	"      --bin-selection NAME  Open bin to pack into (maxrects, guillotine, default: global-best)\n"
+	"                            global-best, first-fit, best-fit, last-fit\n"
+	"      --candidate-queue     Keep the best candidate of every free rectangle queued (maxrects)\n"
+	"      --prune-interval N    Placements between removing redundant free rectangles (maxrects)\n"
+	"      --prune-threshold N   Remove redundant free rectangles early above N of them (maxrects)\n"
+	"      --max-free-rects N    Maximum number of free rectangles per bin (maxrects)\n"
+	"      --eviction NAME       Free rectangles to discard above the maximum (maxrects)\n"
+	"                            smallest-area, thinnest\n"
+	"      --heuristic NAME      Heuristic for finding a free rectangle\n"
+	"                            maxrects: best-short-side-fit, best-long-side-fit, best-area-fit,\n"
+	"                                      bottom-left, contact-point\n"
+	"                            guillotine: best-area-fit, best-short-side-fit, best-long-side-fit,\n"
+	"                                        worst-area-fit, worst-short-side-fit, worst-long-side-fit\n"
+	"      --split NAME          Heuristic for splitting free rectangles (guillotine)\n"
+	"                            shorter-leftover-axis, longer-leftover-axis, minimize-area,\n"
+	"                            maximize-area, shorter-axis, longer-axis\n"
+	"      --padding N           Space between the rectangles and the bin edges (maxrects, guillotine)\n"
+	"      --spacing N           Space between two rectangles (maxrects, guillotine)\n"
+	"      --alignment N         Align positions to multiples of N (maxrects, guillotine)\n"
+	"      --obstacle X,Y,W,H    Block a region in every bin, can be repeated (maxrects, guillotine)\n"
+	"      --node-limit N        Maximum number of search nodes (exact)\n"
+	"      --time-limit MS       Maximum search time in milliseconds (exact)\n"
+	"      --help                Show this help\n";
+
+// Parses a decimal number. Unlike strtoul alone, signs, spaces and values which don't fit into \p max are rejected.
+static bool parseUnsigned(const std::string& value, unsigned long max, unsigned long& out) {
+	if (value.empty() || !std::isdigit((unsigned char) value[0]))
+		return false;
+
+	char* end;
+	errno = 0;
+	out = std::strtoul(value.c_str(), &end, 10);
+	return *end == '\0' && errno != ERANGE && out <= max;
+}
+
+static unsigned long parseNumber(const std::string& value, const std::string& option, unsigned long max = UINT_MAX) {
+	unsigned long result;
+
+	if (!parseUnsigned(value, max, result))
+		throw UsageError("invalid number for " + option + ": " + value);
+
+	return result;
+}
+
+template<typename T>
+static T parseName(const std::string& value, const std::string& option, std::initializer_list<std::pair<const char*, T>> names) {
+	for (auto& name : names)
+		if (value == name.first)
+			return name.second;
+
+	throw UsageError("invalid value for " + option + ": " + value);
+}
+
+static RectBinPack::Rect parseObstacle(const std::string& value, const std::string& option) {
+	unsigned long fields[4];
+	std::size_t begin = 0;
+
+	for (auto i = 0; i < 4; ++i) {
+		const auto end = value.find(',', begin);
+
+		if ((end == std::string::npos) != (i == 3))
+			throw UsageError("invalid value for " + option + ": " + value);
+
+		fields[i] = parseNumber(value.substr(begin, end - begin), option);
+		begin = end + 1;
+	}
+
+	return { (unsigned int) fields[0], (unsigned int) fields[1], (unsigned int) fields[2], (unsigned int) fields[3] };
+}
+
+static Options parseOptions(int argc, char** argv) {
+	using namespace RectBinPack;
+
+	Options options;
+	std::string heuristic;
+	auto hasInput = false;
+
+	for (auto i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+
+		const auto value = [&]() -> std::string {
+			if (i + 1 >= argc)
+				throw UsageError("missing value for " + arg);
+
+			return argv[++i];
+		};
+
+		if (arg == "--help") {
+			options.help = true;
+			return options;
+		}
+		else if (arg == "-o" || arg == "--output")
+			options.output = value();
+		else if (arg == "-f" || arg == "--format")
+			options.outputFormat = parseName<Format>(value(), arg, { { "csv", Format::Csv }, { "json", Format::Json } });
+		else if (arg == "-e" || arg == "--engine")
+			options.engine = parseName<Engine>(value(), arg, {
+				{ "maxrects", Engine::MaxRects }, { "guillotine", Engine::Guillotine }, { "exact", Engine::Exact }
+			});
+		else if (arg == "-w" || arg == "--width")
+			options.width = (unsigned int) parseNumber(value(), arg);
+		else if (arg == "-h" || arg == "--height")
+			options.height = (unsigned int) parseNumber(value(), arg);
+		else if (arg == "--min-bins")
+			options.minBins = (int) parseNumber(value(), arg, INT_MAX);
+		else if (arg == "--max-bins")
+			options.maxBins = (int) parseNumber(value(), arg, INT_MAX);
+		else if (arg == "--flip")
+			options.canFlip = true;
+		else if (arg == "--merge")
+			options.merge = true;
+		else if (arg == "--sequential")
+			options.sequential = true;
+		else if (arg == "--stop-early")
+			options.stopEarly = true;
+		else if (arg == "--bin-selection")
+			options.binSelection = parseName<BinSelection>(value(), arg, {
+				{ "global-best", BinSelection::GlobalBest }, { "first-fit", BinSelection::FirstFit },
+				{ "best-fit", BinSelection::BestFit }, { "last-fit", BinSelection::LastFit }
+			});
+		else if (arg == "--candidate-queue")
+			options.candidateQueue = true;
+		else if (arg == "--prune-interval")
+			options.pruneInterval = (unsigned int) parseNumber(value(), arg);
+		else if (arg == "--prune-threshold")
+			options.pruneThreshold = (unsigned int) parseNumber(value(), arg);
+		else if (arg == "--max-free-rects")
+			options.maxFreeRects = (unsigned int) parseNumber(value(), arg);
+		else if (arg == "--eviction")
+			options.eviction = parseName<MaxRectsEviction>(value(), arg, {
+				{ "smallest-area", MaxRectsEviction::SmallestArea }, { "thinnest", MaxRectsEviction::Thinnest }
+			});
+		else if (arg == "--heuristic")
+			heuristic = value();
+		else if (arg == "--split")
+			options.splitHeuristic = parseName<GuillotineSplitHeuristic>(value(), arg, {
+				{ "shorter-leftover-axis", GuillotineSplitHeuristic::ShorterLeftoverAxis },
+				{ "longer-leftover-axis", GuillotineSplitHeuristic::LongerLeftoverAxis },
+				{ "minimize-area", GuillotineSplitHeuristic::MinimizeArea },
+				{ "maximize-area", GuillotineSplitHeuristic::MaximizeArea },
+				{ "shorter-axis", GuillotineSplitHeuristic::ShorterAxis },
+				{ "longer-axis", GuillotineSplitHeuristic::LongerAxis }
+			});
+		else if (arg == "--padding")
+			options.borderPadding = (unsigned int) parseNumber(value(), arg);
+		else if (arg == "--spacing")
+			options.spacing = (unsigned int) parseNumber(value(), arg);
+		else if (arg == "--alignment")
+			options.alignment = (unsigned int) parseNumber(value(), arg);
+		else if (arg == "--obstacle")
+			options.obstacles.push_back(parseObstacle(value(), arg));
+		else if (arg == "--node-limit")
+			options.nodeLimit = parseNumber(value(), arg, ULONG_MAX);
+		else if (arg == "--time-limit")
+			options.timeLimit = (unsigned int) parseNumber(value(), arg);
+		else if (arg.size() > 1 && arg[0] == '-')
+			throw UsageError("unknown option: " + arg);
+		else if (!hasInput) {
+			options.input = arg;
+			hasInput = true;
+		}
+		else
+			throw UsageError("more than one input given");
+	}
+
+	// Heuristic names depend on the engine, so they are parsed at the end
+	if (!heuristic.empty() && options.engine == Engine::Exact)
+		throw UsageError("--heuristic isn't supported by the exact engine");
+	else if (!heuristic.empty() && options.engine == Engine::MaxRects)
+		options.maxRectsHeuristic = parseName<MaxRectsHeuristic>(heuristic, "--heuristic", {
+			{ "best-short-side-fit", MaxRectsHeuristic::BestShortSideFit },
+			{ "best-long-side-fit", MaxRectsHeuristic::BestLongSideFit },
+			{ "best-area-fit", MaxRectsHeuristic::BestAreaFit },
+			{ "bottom-left", MaxRectsHeuristic::BottomLeftRule },
+			{ "contact-point", MaxRectsHeuristic::ContactPointRule }
+		});
+	else if (!heuristic.empty() && options.engine == Engine::Guillotine)
+		options.guillotineHeuristic = parseName<GuillotineRectHeuristic>(heuristic, "--heuristic", {
+			{ "best-area-fit", GuillotineRectHeuristic::BestAreaFit },
+			{ "best-short-side-fit", GuillotineRectHeuristic::BestShortSideFit },
+			{ "best-long-side-fit", GuillotineRectHeuristic::BestLongSideFit },
+			{ "worst-area-fit", GuillotineRectHeuristic::WorstAreaFit },
+			{ "worst-short-side-fit", GuillotineRectHeuristic::WorstShortSideFit },
+			{ "worst-long-side-fit", GuillotineRectHeuristic::WorstLongSideFit }
+		});
+
+	return options;
+}
+
+// Minimal reader for JSON objects with string and number values. Other values are skipped.
+class JsonLineReader {
+public:
+	JsonLineReader(const std::string& line):
+		m_line(line), m_pos(0) { }
+
+	bool read(Item& item) {
+		auto hasWidth = false, hasHeight = false;
+
+		if (!consume('{'))
+			return false;
+
+		if (consume('}'))
+			return false;
+
+		do {
+			std::string key;
+
+			if (!readString(key) || !consume(':'))
+				return false;
+
+			if (key == "name") {
+				if (!readString(item.name))
+					return false;
+			}
+			else if (key == "width" || key == "height") {
+				unsigned long value;
+
+				if (!readNumber(value))
+					return false;
+
+				(key == "width" ? item.rect.rect.width : item.rect.rect.height) = (unsigned int) value;
+				(key == "width" ? hasWidth : hasHeight) = true;
+			}
+			else if (!skipValue())
+				return false;
+		} while (consume(','));
+
+		return consume('}') && hasWidth && hasHeight;
+	}
+
+private:
+	void skipSpace() {
+		while (m_pos < m_line.size() && std::isspace((unsigned char) m_line[m_pos]))
+			++m_pos;
+	}
+
+	bool consume(char c) {
+		skipSpace();
+
+		if (m_pos < m_line.size() && m_line[m_pos] == c) {
+			++m_pos;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool readString(std::string& out) {
+		if (!consume('"'))
+			return false;
+
+		out.clear();
+
+		while (m_pos < m_line.size() && m_line[m_pos] != '"') {
+			if (m_line[m_pos] != '\\') {
+				out.push_back(m_line[m_pos++]);
+				continue;
+			}
+
+			if (++m_pos >= m_line.size())
+				return false;
+
+			switch (m_line[m_pos++]) {
+			case '"': out.push_back('"'); break;
+			case '\\': out.push_back('\\'); break;
+			case '/': out.push_back('/'); break;
+			case 'b': out.push_back('\b'); break;
+			case 'f': out.push_back('\f'); break;
+			case 'n': out.push_back('\n'); break;
+			case 'r': out.push_back('\r'); break;
+			case 't': out.push_back('\t'); break;
+			case 'u': {
+				unsigned long code;
+
+				if (!readHex(code))
+					return false;
+
+				// Characters outside of the basic plane are written as a surrogate pair
+				if (code >= 0xD800 && code < 0xDC00) {
+					unsigned long low;
+
+					if (m_line.compare(m_pos, 2, "\\u") != 0)
+						return false;
+
+					m_pos += 2;
+
+					if (!readHex(low) || low < 0xDC00 || low >= 0xE000)
+						return false;
+
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				}
+				else if (code >= 0xDC00 && code < 0xE000)
+					return false;
+
+				appendUtf8(out, code);
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+
+		return consume('"');
+	}
+
+	bool readHex(unsigned long& out) {
+		if (m_pos + 4 > m_line.size())
+			return false;
+
+		out = 0;
+
+		for (auto end = m_pos + 4; m_pos < end; ++m_pos) {
+			const auto c = (unsigned char) m_line[m_pos];
+
+			if (!std::isxdigit(c))
+				return false;
+
+			out = out * 16 + (std::isdigit(c) ? c - '0' : std::tolower(c) - 'a' + 10);
+		}
+
+		return true;
+	}
+
+	static void appendUtf8(std::string& out, unsigned long code) {
+		if (code < 0x80)
+			out.push_back((char) code);
+		else if (code < 0x800) {
+			out.push_back((char) (0xC0 | (code >> 6)));
+			out.push_back((char) (0x80 | (code & 0x3F)));
+		}
+		else if (code < 0x10000) {
+			out.push_back((char) (0xE0 | (code >> 12)));
+			out.push_back((char) (0x80 | ((code >> 6) & 0x3F)));
+			out.push_back((char) (0x80 | (code & 0x3F)));
+		}
+		else {
+			out.push_back((char) (0xF0 | (code >> 18)));
+			out.push_back((char) (0x80 | ((code >> 12) & 0x3F)));
+			out.push_back((char) (0x80 | ((code >> 6) & 0x3F)));
+			out.push_back((char) (0x80 | (code & 0x3F)));
+		}
+	}
+
+	bool readNumber(unsigned long& out) {
+		skipSpace();
+
+		const auto begin = m_line.c_str() + m_pos;
+		char* end;
+
+		if (!std::isdigit((unsigned char) *begin))
+			return false;
+
+		errno = 0;
+		out = std::strtoul(begin, &end, 10);
+		m_pos += end - begin;
+		return errno != ERANGE && out <= UINT_MAX;
+	}
+
+	// Skips a value of any type. Commas and braces only end it outside of nested arrays and objects.
+	bool skipValue() {
+		std::vector<char> closing;
+
+		for (;;) {
+			skipSpace();
+
+			if (m_pos >= m_line.size())
+				return false;
+
+			const auto c = m_line[m_pos];
+
+			if (c == '"') {
+				std::string ignored;
+
+				if (!readString(ignored))
+					return false;
+			}
+			else if (c == '[' || c == '{') {
+				closing.push_back(c == '[' ? ']' : '}');
+				++m_pos;
+			}
+			else if (c == ']' || c == '}' || c == ',') {
+				if (closing.empty())
+					return true;
+
+				if (c != ',') {
+					if (c != closing.back())
+						return false;
+
+					closing.pop_back();
+				}
+
+				++m_pos;
+			}
+			else
+				++m_pos;
+		}
+	}
+
+	const std::string& m_line;
+	std::size_t m_pos;
+};
+
+// Splits a CSV line into its fields. Fields in double quotes can contain commas and doubled quotes.
+static bool splitCsvLine(const std::string& line, std::vector<std::string>& fields) {
+	std::size_t pos = 0;
+
+	for (;;) {
+		std::string field;
+
+		if (pos < line.size() && line[pos] == '"') {
+			for (++pos;; ++pos) {
+				if (pos >= line.size())
+					return false;
+
+				if (line[pos] == '"') {
+					if (pos + 1 >= line.size() || line[pos + 1] != '"')
+						break;
+
+					++pos;
+				}
+
+				field.push_back(line[pos]);
+			}
+
+			++pos;
+
+			if (pos < line.size() && line[pos] != ',')
+				return false;
+		}
+		else {
+			const auto end = std::min(line.find(',', pos), line.size());
+			field = line.substr(pos, end - pos);
+			pos = end;
+		}
+
+		fields.push_back(field);
+
+		if (pos >= line.size())
+			return true;
+
+		++pos;
+	}
+}
+
+static bool parseCsvLine(const std::string& line, Item& item) {
+	std::vector<std::string> fields;
+
+	if (!splitCsvLine(line, fields) || (fields.size() != 2 && fields.size() != 3))
+		return false;
+
+	if (fields.size() == 3)
+		item.name = fields[0];
+
+	unsigned long width, height;
+
+	if (!parseUnsigned(fields[fields.size() - 2], UINT_MAX, width) || !parseUnsigned(fields[fields.size() - 1], UINT_MAX, height))
+		return false;
+
+	item.rect.rect.width = (unsigned int) width;
+	item.rect.rect.height = (unsigned int) height;
+	return true;
+}
+
+// Reads items line by line directly into the vector which is packed
+static void readItems(std::istream& stream, std::vector<Item>& items) {
+	std::string line;
+	auto lineNumber = 0u;
+
+	while (std::getline(stream, line)) {
+		++lineNumber;
+
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		const auto first = line.find_first_not_of(" \t");
+
+		if (first == std::string::npos || line[first] == '#')
+			continue;
+
+		items.push_back({ {}, { { 0, 0, 0, 0 }, RectBinPack::InvalidBin, false } });
+		auto& item = items.back();
+
+		const auto valid = line[first] == '{' ?
+			JsonLineReader(line).read(item) :
+			parseCsvLine(line, item);
+
+		if (!valid)
+			throw std::runtime_error("invalid rectangle in line " + std::to_string(lineNumber));
+	}
+}
+
+static void writeJsonString(std::ostream& stream, const std::string& value) {
+	stream << '"';
+
+	for (auto c : value) {
+		if (c == '"' || c == '\\')
+			stream << '\\' << c;
+		else if ((unsigned char) c < 0x20) {
+			const char* hex = "0123456789abcdef";
+			stream << "\\u00" << hex[(c >> 4) & 0xF] << hex[c & 0xF];
+		}
+		else
+			stream << c;
+	}
+
+	stream << '"';
+}
+
+// Quotes the value if it contains characters which have a meaning in CSV
+static void writeCsvString(std::ostream& stream, const std::string& value) {
+	if (value.find_first_of(",\"\r\n") == std::string::npos && (value.empty() || value[0] != '#')) {
+		stream << value;
+		return;
+	}
+
+	stream << '"';
+
+	for (auto c : value) {
+		if (c == '"')
+			stream << '"';
+
+		stream << c;
+	}
+
+	stream << '"';
+}
+
+static void writeItems(std::ostream& stream, const std::vector<Item>& items, Format format) {
+	if (format == Format::Csv)
+		stream << "name,x,y,width,height,bin,flipped\n";
+
+	for (auto& item : items) {
+		const auto& rect = item.rect.rect;
+		const auto bin = item.rect.bin == RectBinPack::InvalidBin ? -1 : (long long) item.rect.bin;
+
+		if (format == Format::Csv) {
+			writeCsvString(stream, item.name);
+			stream << ',' << rect.x << ',' << rect.y << ',' << rect.width << ',' << rect.height << ','
+				<< bin << ',' << (item.rect.flipped ? 1 : 0) << '\n';
+		}
+		else {
+			stream << "{\"name\":";
+			writeJsonString(stream, item.name);
+			stream << ",\"x\":" << rect.x << ",\"y\":" << rect.y << ",\"width\":" << rect.width
+				<< ",\"height\":" << rect.height << ",\"bin\":" << bin
+				<< ",\"flipped\":" << (item.rect.flipped ? "true" : "false") << "}\n";
+		}
+	}
+}
+
+static RectBinPack::Result pack(const Options& options, std::vector<Item>& items) {
+	using namespace RectBinPack;
+
+	switch (options.engine) {
+	case Engine::Guillotine: {
+		GuillotineConfiguration config {};
+		config.width = options.width;
+		config.height = options.height;
+		config.minBins = options.minBins;
+		config.maxBins = options.maxBins;
+		config.canFlip = options.canFlip;
+		config.merge = options.merge;
+		config.rectHeuristic = options.guillotineHeuristic;
+		config.splitHeuristic = options.splitHeuristic;
+		config.borderPadding = options.borderPadding;
+		config.spacing = options.spacing;
+		config.alignment = options.alignment;
+		config.obstacles = options.obstacles;
+		config.binSelection = options.binSelection;
+		config.sequential = options.sequential;
+		config.stopEarly = options.stopEarly;
+
+		return packGuillotine(config, items);
+	}
+	case Engine::Exact: {
+		ExactConfiguration config {};
+		config.width = options.width;
+		config.height = options.height;
+		config.minBins = options.minBins;
+		config.maxBins = options.maxBins;
+		config.canFlip = options.canFlip;
+		config.nodeLimit = options.nodeLimit;
+		config.timeLimit = options.timeLimit;
+
+		return packExact(config, items);
+	}
+	default: {
+		MaxRectsConfiguration config {};
+		config.width = options.width;
+		config.height = options.height;
+		config.minBins = options.minBins;
+		config.maxBins = options.maxBins;
+		config.canFlip = options.canFlip;
+		config.rectHeuristic = options.maxRectsHeuristic;
+		config.borderPadding = options.borderPadding;
+		config.spacing = options.spacing;
+		config.alignment = options.alignment;
+		config.obstacles = options.obstacles;
+		config.candidateQueue = options.candidateQueue;
+		config.pruneInterval = options.pruneInterval;
+		config.pruneThreshold = options.pruneThreshold;
+		config.maxFreeRects = options.maxFreeRects;
+		config.eviction = options.eviction;
+		config.binSelection = options.binSelection;
+		config.stopEarly = options.stopEarly;
+
+		return packMaxRects(config, items);
+	}
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options;
+
+	try {
+		options = parseOptions(argc, argv);
+	}
+	catch (const UsageError& e) {
+		std::cerr << "Error: " << e.what() << "\n\n" << usage;
+		return 2;
+	}
+
+	if (options.help) {
+		std::cout << usage;
+		return 0;
+	}
+
+	try {
+		std::vector<Item> items;
+
+		if (options.input == "-")
+			readItems(std::cin, items);
+		else {
+			std::ifstream stream(options.input);
+
+			if (!stream)
+				throw std::runtime_error("cannot open " + options.input);
+
+			readItems(stream, items);
+		}
+
+		const auto result = pack(options, items);
+
+		if (options.output == "-")
+			writeItems(std::cout, items, options.outputFormat);
+		else {
+			std::ofstream stream(options.output);
+
+			if (!stream)
+				throw std::runtime_error("cannot open " + options.output);
+
+			writeItems(stream, items, options.outputFormat);
+		}
+
+		const auto packed = std::count_if(items.begin(), items.end(), [](const Item& item) {
+			return item.rect.bin != RectBinPack::InvalidBin;
+		});
+
+		std::cerr << packed << " of " << items.size() << " rectangles packed into " << result.numBins << " bins" << std::endl;
+
+		if (result.failed) {
+			std::cerr << "Warning: not all rectangles were packed" << std::endl;
+			return 1;
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 2;
+	}
+
+	return 0;
+}
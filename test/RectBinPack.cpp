@@ -2,12 +2,55 @@
 #include <catch.hpp>
 
 #include <RectBinPack/RectBinPack.hpp>
+#include <RectBinPack/BinaryFormat.hpp>
+#include <RectBinPack/BinTypes.hpp>
+#include <RectBinPack/Cache.hpp>
+#ifdef ENABLE_COMPOSITOR
+#	include <RectBinPack/Compositor.hpp>
+#endif
+#include <RectBinPack/Exact.hpp>
 #include <RectBinPack/Guillotine.hpp>
 #include <RectBinPack/MaxRects.hpp>
+#include <RectBinPack/MinimumSize.hpp>
+#include <RectBinPack/Packer.hpp>
+#include <RectBinPack/Repack.hpp>
+#include <RectBinPack/Validate.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <random>
 
 using namespace RectBinPack;
 
+/// Returns a configuration with the basic options set, every other option keeps its default
+static MaxRectsConfiguration makeMaxRectsConfig(unsigned int width, unsigned int height, int minBins, int maxBins, bool canFlip, MaxRectsHeuristic rectHeuristic) {
+	MaxRectsConfiguration config {};
+	config.width = width;
+	config.height = height;
+	config.minBins = minBins;
+	config.maxBins = maxBins;
+	config.canFlip = canFlip;
+	config.rectHeuristic = rectHeuristic;
+	return config;
+}
+
+/// Returns a configuration with the basic options set, every other option keeps its default
+static GuillotineConfiguration makeGuillotineConfig(
+	unsigned int width, unsigned int height, int minBins, int maxBins, bool canFlip, bool merge,
+	GuillotineRectHeuristic rectHeuristic, GuillotineSplitHeuristic splitHeuristic
+) {
+	GuillotineConfiguration config {};
+	config.width = width;
+	config.height = height;
+	config.minBins = minBins;
+	config.maxBins = maxBins;
+	config.canFlip = canFlip;
+	config.merge = merge;
+	config.rectHeuristic = rectHeuristic;
+	config.splitHeuristic = splitHeuristic;
+	return config;
+}
+
 static std::vector<BinRect> prepareVector(unsigned int seed, unsigned int initialBin = 0) {
 	std::minstd_rand rand(seed);
 	std::vector<BinRect> rects;
@@ -46,14 +89,41 @@ static void validateRects(Result result, const std::vector<BinRect>& rects, unsi
 			REQUIRE(!rects[i].rect.intersect(rects[j].rect));
 		}
 	}
+
+	CHECK(validatePacking(result, width, height, rects).error == ValidationError::None);
+}
+
+static void validateLayout(const std::vector<BinRect>& rects, unsigned int width, unsigned int height, unsigned int borderPadding, unsigned int spacing, unsigned int alignment) {
+	for (auto i = 0u; i < rects.size(); ++i) {
+		if (rects[i].bin == InvalidBin)
+			continue;
+
+		const auto& rect = rects[i].rect;
+
+		CHECK(rect.x % alignment == 0);
+		CHECK(rect.y % alignment == 0);
+		CHECK(rect.left() >= borderPadding);
+		CHECK(rect.top() >= borderPadding);
+		CHECK(rect.right() + borderPadding <= width);
+		CHECK(rect.bottom() + borderPadding <= height);
+
+		for (auto j = i + 1; j < rects.size(); ++j) {
+			if (rects[i].bin != rects[j].bin)
+				continue;
+
+			const Rect spaced { rect.x, rect.y, rect.width + spacing, rect.height + spacing };
+			const Rect otherSpaced { rects[j].rect.x, rects[j].rect.y, rects[j].rect.width + spacing, rects[j].rect.height + spacing };
+
+			REQUIRE(!spaced.intersect(rects[j].rect));
+			REQUIRE(!otherSpaced.intersect(rect));
+		}
+	}
 }
 
 static void testGuillotine(GuillotineRectHeuristic rectHeuristic, GuillotineSplitHeuristic splitHeuristic, bool merge, unsigned int seed) {
 	auto rects = prepareVector(seed);
 
-	GuillotineConfiguration config {
-		100, 100, 1, UnlimitedBins, true, merge, rectHeuristic, splitHeuristic
-	};
+	auto config = makeGuillotineConfig(100, 100, 1, UnlimitedBins, true, merge, rectHeuristic, splitHeuristic);
 
 	validateRects(packGuillotine(config, rects), rects, 100, 100);
 }
@@ -75,13 +145,26 @@ static void testGuillotineRectHeuristic(GuillotineRectHeuristic rectHeuristic, u
 static void testMaxRects(MaxRectsHeuristic heuristic, unsigned int seed) {
 	auto rects = prepareVector(seed);
 
-	MaxRectsConfiguration config {
-		45, 45, 1, UnlimitedBins, true, heuristic
-	};
+	auto config = makeMaxRectsConfig(45, 45, 1, UnlimitedBins, true, heuristic);
 
 	validateRects(packMaxRects(config, rects), rects, 45, 45);
 }
 
+static void testExact(unsigned int seed) {
+	auto rects = prepareVector(seed);
+	auto greedyRects = rects;
+
+	ExactConfiguration config {
+		45, 45, 1, UnlimitedBins, true, 10000, 0
+	};
+
+	auto greedyConfig = makeMaxRectsConfig(45, 45, 1, UnlimitedBins, true, MaxRectsHeuristic::BestShortSideFit);
+
+	const auto result = packExact(config, rects);
+	validateRects(result, rects, 45, 45);
+	CHECK(result.numBins <= packMaxRects(greedyConfig, greedyRects).numBins);
+}
+
 TEST_CASE("Coordinates", "[Rect]") {
 	Rect rect { 10, 20, 30, 40 };
 
@@ -152,6 +235,41 @@ TEST_CASE("Vector Erase", "[Internal]") {
 	REQUIRE(vec.empty());
 }
 
+TEST_CASE("Rect Groups", "[Internal]") {
+	std::vector<int> items { 0, 1, 2, 3 };
+	Internal::RectGroups<std::vector<int>::iterator> groups;
+
+	CHECK(groups.add(items.begin(), { 0, 0, 2, 3 }) == 0);
+	CHECK(groups.add(items.begin() + 1, { 0, 0, 3, 2 }) == 1);
+	CHECK(groups.add(items.begin() + 2, { 0, 0, 2, 3 }) == 0);
+	CHECK(groups.add(items.begin() + 3, { 0, 0, 2, 3 }) == 0);
+
+	REQUIRE(groups.numGroups() == 2);
+	REQUIRE(groups.size() == 4);
+	CHECK(groups[0].count() == 3);
+	CHECK(groups[1].count() == 1);
+
+	std::size_t group;
+	CHECK(groups.find(3, 2, group));
+	CHECK(group == 1);
+	CHECK(!groups.find(2, 2, group));
+
+	// Rectangles are taken in input order
+	CHECK(*groups.take(0) == 0);
+	CHECK(*groups.take(1) == 1);
+	CHECK(groups.active() == std::vector<std::size_t> { 0 });
+	CHECK(!groups.find(3, 2, group));
+	CHECK(*groups.take(0) == 2);
+
+	std::vector<int> left;
+	groups.forEach([&](std::vector<int>::iterator it) { left.push_back(*it); });
+	CHECK(left == std::vector<int> { 3 });
+
+	CHECK(*groups.take(0) == 3);
+	CHECK(groups.empty());
+	CHECK(groups.active().empty());
+}
+
 TEST_CASE("To Rect", "[BinRect Conversion]") {
 	BinRect rect { { 1, 2, 3, 4 }, 0, false };
 
@@ -200,7 +318,7 @@ TEST_CASE("MaxRects", "[MaxRects]") {
 }
 
 TEST_CASE("Guillotine Too Big Exception", "[Guillotine]") {
-	GuillotineConfiguration config { 10, 20, 1, UnlimitedBins, false, true, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MaximizeArea };
+	auto config = makeGuillotineConfig(10, 20, 1, UnlimitedBins, false, true, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MaximizeArea);
 	std::vector<BinRect> rects { { { 0, 0, 15, 10 }, InvalidBin, false } };
 
 	CHECK_THROWS(packGuillotine(config, rects));
@@ -209,7 +327,7 @@ TEST_CASE("Guillotine Too Big Exception", "[Guillotine]") {
 }
 
 TEST_CASE("MaxRects Too Big Exception", "[MaxRects]") {
-	MaxRectsConfiguration config { 10, 20, 1, UnlimitedBins, false, MaxRectsHeuristic::BestAreaFit };
+	auto config = makeMaxRectsConfig(10, 20, 1, UnlimitedBins, false, MaxRectsHeuristic::BestAreaFit);
 	std::vector<BinRect> rects { { { 0, 0, 15, 10 }, InvalidBin, false } };
 
 	CHECK_THROWS(packMaxRects(config, rects));
@@ -221,7 +339,7 @@ TEST_CASE("Guillotine Failed", "[Guillotine]") {
 	const auto seed = 0u;
 	auto rects = prepareVector(seed, 10);
 
-	GuillotineConfiguration config { 20, 20, 1, 1, false, true, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MaximizeArea };
+	auto config = makeGuillotineConfig(20, 20, 1, 1, false, true, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MaximizeArea);
 	REQUIRE(packGuillotine(config, rects).failed);
 
 	CHECK(!std::any_of(rects.begin(), rects.end(), [](const BinRect& rect) {
@@ -233,10 +351,1349 @@ TEST_CASE("MaxRects Failed", "[MaxRects]") {
 	const auto seed = 0u;
 	auto rects = prepareVector(seed, 10);
 
-	MaxRectsConfiguration config { 20, 20, 1, 1, false, MaxRectsHeuristic::BestAreaFit };
+	auto config = makeMaxRectsConfig(20, 20, 1, 1, false, MaxRectsHeuristic::BestAreaFit);
 	REQUIRE(packMaxRects(config, rects).failed);
 
 	CHECK(!std::any_of(rects.begin(), rects.end(), [](const BinRect& rect) {
 		return rect.bin != 0 && rect.bin != InvalidBin;
 	}));
 }
+
+TEST_CASE("Guillotine Cannot Fit", "[Guillotine]") {
+	std::vector<BinRect> rects { { { 0, 0, 15, 15 }, 0, false }, { { 0, 0, 10, 10 }, 0, false } };
+
+	// The area fits, but there is no free space of 10x10 left after the first rectangle
+	auto config = makeGuillotineConfig(20, 20, 1, 1, false, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MaximizeArea);
+	config.stopEarly = true;
+	REQUIRE(packGuillotine(config, rects).failed);
+
+	CHECK(rects[0].bin == 0);
+	CHECK(rects[1].bin == InvalidBin);
+}
+
+TEST_CASE("MaxRects Cannot Fit", "[MaxRects]") {
+	std::vector<BinRect> rects { { { 0, 0, 15, 15 }, 0, false }, { { 0, 0, 15, 15 }, 0, false }, { { 0, 0, 3, 3 }, 0, false } };
+
+	auto config = makeMaxRectsConfig(20, 20, 1, 1, true, MaxRectsHeuristic::BestAreaFit);
+
+	SECTION("Partial") {
+		// Everything which fits is packed
+		REQUIRE(packMaxRects(config, rects).failed);
+
+		CHECK(std::count_if(rects.begin(), rects.end(), [](const BinRect& rect) { return rect.bin == 0; }) == 2);
+		CHECK(rects[2].bin == 0);
+	}
+
+	SECTION("Stop Early") {
+		// The area is too large, so nothing is packed at all
+		config.stopEarly = true;
+		REQUIRE(packMaxRects(config, rects).failed);
+
+		CHECK(std::all_of(rects.begin(), rects.end(), [](const BinRect& rect) {
+			return rect.bin == InvalidBin;
+		}));
+	}
+}
+
+TEST_CASE("Guillotine Layout", "[Guillotine]") {
+	const auto seed = 0u;
+
+	for (auto i = 0u; i < 25; ++i) {
+		auto rects = prepareVector(seed + i);
+
+		auto config = makeGuillotineConfig(100, 100, 1, UnlimitedBins, true, true, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MaximizeArea);
+		config.borderPadding = 2;
+		config.spacing = 3;
+		config.alignment = 4;
+
+		validateRects(packGuillotine(config, rects), rects, 100, 100);
+		validateLayout(rects, 100, 100, 2, 3, 4);
+	}
+}
+
+TEST_CASE("MaxRects Layout", "[MaxRects]") {
+	const auto seed = 0u;
+
+	for (auto i = 0u; i < 25; ++i) {
+		auto rects = prepareVector(seed + i);
+
+		auto config = makeMaxRectsConfig(45, 45, 1, UnlimitedBins, true, MaxRectsHeuristic::BestShortSideFit);
+		config.borderPadding = 2;
+		config.spacing = 3;
+		config.alignment = 4;
+
+		validateRects(packMaxRects(config, rects), rects, 45, 45);
+		validateLayout(rects, 45, 45, 2, 3, 4);
+	}
+}
+
+TEST_CASE("Guillotine Identical Sizes", "[Guillotine]") {
+	std::vector<BinRect> rects(120, { { 0, 0, 10, 5 }, InvalidBin, false });
+
+	auto config = makeGuillotineConfig(50, 50, 1, UnlimitedBins, true, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+
+	const auto result = packGuillotine(config, rects);
+	validateRects(result, rects, 50, 50);
+	CHECK(result.numBins == 3);
+}
+
+TEST_CASE("Guillotine Perfect Fit", "[Guillotine]") {
+	for (auto merge : { false, true }) {
+		std::vector<BinRect> rects {
+			{ { 0, 0, 10, 4 }, InvalidBin, false },
+			{ { 0, 0, 6, 10 }, InvalidBin, false },
+			{ { 0, 0, 2, 2 }, InvalidBin, false }
+		};
+
+		auto config = makeGuillotineConfig(10, 10, 1, UnlimitedBins, true, merge, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+
+		const auto result = packGuillotine(config, rects);
+		validateRects(result, rects, 10, 10);
+		CHECK(result.numBins == 2);
+
+		// The space left next to the second rectangle is exactly the size of the first one flipped
+		CHECK(rects[0].bin == 0);
+		CHECK(rects[0].flipped);
+		CHECK(rects[0].rect == Rect { 6, 0, 4, 10 });
+	}
+}
+
+TEST_CASE("Guillotine Merge", "[Guillotine]") {
+	for (auto merge : { false, true }) {
+		std::vector<BinRect> first { { { 0, 0, 2, 4 }, InvalidBin, false } };
+		std::vector<BinRect> second { { { 0, 0, 6, 4 }, InvalidBin, false } };
+		Internal::GuillotineState state {};
+
+		const auto config = makeGuillotineConfig(8, 8, 1, 1, false, merge, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::ShorterLeftoverAxis);
+
+		REQUIRE(Internal::Guillotine<std::vector<BinRect>::iterator>(first.begin(), first.end(), 0, config).pack(state));
+		REQUIRE(Internal::Guillotine<std::vector<BinRect>::iterator>(second.begin(), second.end(), 0, config).pack(state));
+		CHECK(second[0].rect == Rect { 2, 0, 6, 4 });
+
+		// The spaces below both rectangles share a full edge, so merging joins them
+		const auto& freeRects = state.bins[0].freeRects;
+
+		if (merge)
+			CHECK(freeRects == std::vector<Rect> { { 0, 4, 8, 4 } });
+		else {
+			REQUIRE(freeRects.size() == 2);
+			CHECK(std::count(freeRects.begin(), freeRects.end(), Rect { 0, 4, 2, 4 }) == 1);
+			CHECK(std::count(freeRects.begin(), freeRects.end(), Rect { 2, 4, 6, 4 }) == 1);
+		}
+	}
+}
+
+TEST_CASE("Guillotine Sequential", "[Guillotine]") {
+	const GuillotineRectHeuristic heuristics[] = { GuillotineRectHeuristic::BestAreaFit, GuillotineRectHeuristic::BestShortSideFit };
+
+	for (auto heuristic : heuristics) {
+		for (auto i = 0u; i < 25; ++i) {
+			auto rects = prepareVector(i);
+
+			std::stable_sort(rects.begin(), rects.end(), [](const BinRect& a, const BinRect& b) {
+				return a.rect.width * a.rect.height > b.rect.width * b.rect.height;
+			});
+
+			auto config = makeGuillotineConfig(30, 30, 1, UnlimitedBins, true, i % 2 == 0, heuristic, GuillotineSplitHeuristic::MinimizeArea);
+			config.sequential = true;
+
+			validateRects(packGuillotine(config, rects), rects, 30, 30);
+		}
+	}
+}
+
+TEST_CASE("Guillotine Sequential Order", "[Guillotine]") {
+	std::vector<BinRect> rects {
+		{ { 0, 0, 2, 2 }, InvalidBin, false },
+		{ { 0, 0, 10, 10 }, InvalidBin, false }
+	};
+
+	auto config = makeGuillotineConfig(10, 10, 1, UnlimitedBins, false, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+
+	// The perfect fit is packed first otherwise
+	packGuillotine(config, rects);
+	CHECK(rects[0].bin == 1);
+	CHECK(rects[1].bin == 0);
+
+	config.sequential = true;
+
+	const auto result = packGuillotine(config, rects);
+	validateRects(result, rects, 10, 10);
+	CHECK(rects[0].bin == 0);
+	CHECK(rects[1].bin == 1);
+}
+
+TEST_CASE("MaxRects Identical Sizes", "[MaxRects]") {
+	std::vector<BinRect> rects(120, { { 0, 0, 10, 5 }, InvalidBin, false });
+
+	auto config = makeMaxRectsConfig(50, 50, 1, UnlimitedBins, true, MaxRectsHeuristic::BestShortSideFit);
+
+	const auto result = packMaxRects(config, rects);
+	validateRects(result, rects, 50, 50);
+	CHECK(result.numBins == 3);
+}
+
+static bool samePlacement(const std::vector<BinRect>& a, const std::vector<BinRect>& b) {
+	return std::equal(a.begin(), a.end(), b.begin(), [](const BinRect& first, const BinRect& second) {
+		return first.rect == second.rect && first.bin == second.bin && first.flipped == second.flipped;
+	});
+}
+
+TEST_CASE("MaxRects Candidate Queue", "[MaxRects]") {
+	const MaxRectsHeuristic heuristics[] = {
+		MaxRectsHeuristic::BestShortSideFit, MaxRectsHeuristic::BestLongSideFit, MaxRectsHeuristic::BestAreaFit,
+		MaxRectsHeuristic::BottomLeftRule
+	};
+
+	SECTION("Valid") {
+		for (auto heuristic : heuristics) {
+			for (auto i = 0u; i < 25; ++i) {
+				auto rects = prepareVector(i);
+
+				auto config = makeMaxRectsConfig(45, 45, 1, UnlimitedBins, true, heuristic);
+				config.candidateQueue = true;
+
+				validateRects(packMaxRects(config, rects), rects, 45, 45);
+			}
+		}
+	}
+
+	SECTION("Same As Scan") {
+		// No two candidates get the same score, so the queue picks the same best candidate as the scan every time
+		const std::vector<BinRect> original {
+			{ { 0, 0, 7, 5 }, 0, false }, { { 0, 0, 4, 6 }, 0, false }, { { 0, 0, 3, 2 }, 0, false },
+			{ { 0, 0, 5, 3 }, 0, false }, { { 0, 0, 2, 9 }, 0, false }
+		};
+
+		for (auto heuristic : heuristics) {
+			auto scanRects = original;
+			auto queueRects = original;
+
+			auto config = makeMaxRectsConfig(12, 12, 1, UnlimitedBins, false, heuristic);
+			const auto scanResult = packMaxRects(config, scanRects);
+
+			config.candidateQueue = true;
+			const auto queueResult = packMaxRects(config, queueRects);
+
+			CHECK(queueResult.numBins == scanResult.numBins);
+			CHECK(samePlacement(queueRects, scanRects));
+		}
+	}
+
+	SECTION("Contact Point Fallback") {
+		// The queue is ignored for ContactPointRule, so it packs exactly like the scan
+		for (auto i = 0u; i < 25; ++i) {
+			auto scanRects = prepareVector(i);
+			auto queueRects = scanRects;
+
+			auto config = makeMaxRectsConfig(45, 45, 1, UnlimitedBins, true, MaxRectsHeuristic::ContactPointRule);
+			packMaxRects(config, scanRects);
+
+			config.candidateQueue = true;
+			packMaxRects(config, queueRects);
+
+			CHECK(samePlacement(queueRects, scanRects));
+		}
+	}
+}
+
+TEST_CASE("MaxRects Lower Bound", "[MaxRects]") {
+	// Skipping bins and free rectangles which can't beat the best score so far doesn't change the placements
+	const MaxRectsHeuristic heuristics[] = {
+		MaxRectsHeuristic::BestShortSideFit, MaxRectsHeuristic::BestAreaFit, MaxRectsHeuristic::BottomLeftRule
+	};
+
+	for (auto heuristic : heuristics) {
+		for (auto i = 0u; i < 25; ++i) {
+			auto skipRects = prepareVector(i);
+			auto scanRects = skipRects;
+
+			auto config = makeMaxRectsConfig(30, 30, 3, UnlimitedBins, i % 2 == 0, heuristic);
+
+			Internal::MaxRects<std::vector<BinRect>::iterator> skip(skipRects.begin(), skipRects.end(), skipRects.size(), config);
+			Internal::MaxRects<std::vector<BinRect>::iterator> scan(scanRects.begin(), scanRects.end(), scanRects.size(), config);
+			scan.disableLowerBound();
+
+			REQUIRE(skip.pack() == scan.pack());
+			CHECK(skip.numBins() == scan.numBins());
+			CHECK(samePlacement(skipRects, scanRects));
+		}
+	}
+}
+
+TEST_CASE("Guillotine Open Bins", "[Guillotine]") {
+	for (auto i = 0u; i < 25; ++i) {
+		auto rects = prepareVector(i);
+
+		auto config = makeGuillotineConfig(30, 30, 3, UnlimitedBins, i % 2 == 0, true, GuillotineRectHeuristic::BestShortSideFit, GuillotineSplitHeuristic::MinimizeArea);
+
+		const auto result = packGuillotine(config, rects);
+		validateRects(result, rects, 30, 30);
+		CHECK(result.numBins >= 3);
+	}
+}
+
+TEST_CASE("MaxRects Open Bins", "[MaxRects]") {
+	for (auto i = 0u; i < 25; ++i) {
+		auto rects = prepareVector(i);
+
+		auto config = makeMaxRectsConfig(30, 30, 3, UnlimitedBins, i % 2 == 0, MaxRectsHeuristic::BestAreaFit);
+
+		const auto result = packMaxRects(config, rects);
+		validateRects(result, rects, 30, 30);
+		CHECK(result.numBins >= 3);
+	}
+}
+
+/// Returns the number of free rectangles which lie inside another one
+static std::size_t countContained(const std::vector<Rect>& freeRects) {
+	return std::count_if(freeRects.begin(), freeRects.end(), [&](const Rect& rect) {
+		return std::any_of(freeRects.begin(), freeRects.end(), [&](const Rect& other) {
+			return &other != &rect && rect.isContainedIn(other);
+		});
+	});
+}
+
+TEST_CASE("MaxRects Deferred Prune", "[MaxRects]") {
+	SECTION("Valid") {
+		for (auto i = 0u; i < 25; ++i) {
+			auto rects = prepareVector(i);
+			auto thresholdRects = rects;
+
+			auto config = makeMaxRectsConfig(45, 45, 1, UnlimitedBins, true, MaxRectsHeuristic::BestShortSideFit);
+			config.pruneInterval = 8;
+
+			validateRects(packMaxRects(config, rects), rects, 45, 45);
+
+			config.pruneThreshold = 16;
+			validateRects(packMaxRects(config, thresholdRects), thresholdRects, 45, 45);
+		}
+	}
+
+	// Occupying space splits the free rectangles like a placement, but leaves them as they are afterwards
+	const Rect occupied[] = { { 2, 2, 2, 2 }, { 8, 8, 2, 2 }, { 14, 4, 2, 2 }, { 4, 14, 2, 2 } };
+	std::vector<BinRect> none;
+	Internal::MaxRectsState state {};
+
+	auto config = makeMaxRectsConfig(20, 20, 1, UnlimitedBins, false, MaxRectsHeuristic::BestAreaFit);
+
+	SECTION("Interval") {
+		config.pruneInterval = 4;
+		Internal::MaxRects<std::vector<BinRect>::iterator> maxRects(none.begin(), none.end(), 0, config);
+
+		for (auto i = 0; i < 3; ++i)
+			REQUIRE(maxRects.occupy(state, 0, occupied[i]));
+
+		// Contained free rectangles survive until the fourth split
+		CHECK(state.bins[0].unprunedSplits == 3);
+		CHECK(countContained(state.bins[0].freeRects) > 0);
+
+		REQUIRE(maxRects.occupy(state, 0, occupied[3]));
+		CHECK(state.bins[0].unprunedSplits == 0);
+		CHECK(countContained(state.bins[0].freeRects) == 0);
+	}
+
+	SECTION("Threshold") {
+		config.pruneInterval = 100;
+		config.pruneThreshold = 12;
+		Internal::MaxRects<std::vector<BinRect>::iterator> maxRects(none.begin(), none.end(), 0, config);
+
+		for (auto i = 0; i < 2; ++i)
+			REQUIRE(maxRects.occupy(state, 0, occupied[i]));
+
+		// Still at most 12 free rectangles, some of them inside others
+		CHECK(state.bins[0].freeRects.size() <= 12);
+		CHECK(countContained(state.bins[0].freeRects) > 0);
+
+		// The third split goes above the threshold
+		REQUIRE(maxRects.occupy(state, 0, occupied[2]));
+		CHECK(state.bins[0].unprunedSplits == 0);
+		CHECK(countContained(state.bins[0].freeRects) == 0);
+	}
+
+	SECTION("End Of Packing") {
+		config.pruneInterval = 100;
+		Internal::MaxRects<std::vector<BinRect>::iterator> maxRects(none.begin(), none.end(), 0, config);
+
+		for (auto& rect : occupied)
+			REQUIRE(maxRects.occupy(state, 0, rect));
+
+		CHECK(countContained(state.bins[0].freeRects) > 0);
+
+		// Packing prunes the bins before it returns, even if the interval wasn't reached
+		std::vector<BinRect> rects { { { 0, 0, 1, 1 }, 0, false } };
+		Internal::MaxRects<std::vector<BinRect>::iterator> packing(rects.begin(), rects.end(), rects.size(), config);
+
+		REQUIRE(packing.pack(state));
+		CHECK(state.bins[0].unprunedSplits == 0);
+		CHECK(countContained(state.bins[0].freeRects) == 0);
+	}
+}
+
+TEST_CASE("MaxRects Free Rectangle Limit", "[MaxRects]") {
+	const MaxRectsEviction evictions[] = { MaxRectsEviction::SmallestArea, MaxRectsEviction::Thinnest };
+
+	SECTION("Valid") {
+		for (auto eviction : evictions) {
+			for (auto i = 0u; i < 25; ++i) {
+				auto rects = prepareVector(i);
+
+				auto config = makeMaxRectsConfig(45, 45, 1, UnlimitedBins, true, MaxRectsHeuristic::BestAreaFit);
+				config.maxFreeRects = 4;
+				config.eviction = eviction;
+
+				validateRects(packMaxRects(config, rects), rects, 45, 45);
+			}
+		}
+	}
+
+	SECTION("Evicted Rectangle") {
+		// Without a limit the free rectangles are 20x6, 20x2, 2x20, 3x13 and 16x13. The 3x13 one has the smallest
+		// area, the 20x2 one the shortest side.
+		const Rect occupied[] = { { 16, 9, 1, 11 }, { 2, 6, 18, 1 } };
+		const Rect smallest { 17, 7, 3, 13 };
+		const Rect thinnest { 0, 7, 20, 2 };
+
+		for (auto eviction : evictions) {
+			auto config = makeMaxRectsConfig(20, 20, 1, UnlimitedBins, false, MaxRectsHeuristic::BestAreaFit);
+			config.maxFreeRects = 4;
+			config.eviction = eviction;
+
+			std::vector<BinRect> none;
+			Internal::MaxRectsState state {};
+			Internal::MaxRects<std::vector<BinRect>::iterator> maxRects(none.begin(), none.end(), 0, config);
+
+			for (auto& rect : occupied) {
+				REQUIRE(maxRects.occupy(state, 0, rect));
+				CHECK(state.bins[0].freeRects.size() <= 4);
+			}
+
+			const auto& freeRects = state.bins[0].freeRects;
+			const auto hasSmallest = std::find(freeRects.begin(), freeRects.end(), smallest) != freeRects.end();
+			const auto hasThinnest = std::find(freeRects.begin(), freeRects.end(), thinnest) != freeRects.end();
+
+			CHECK(freeRects.size() == 4);
+			CHECK(hasSmallest == (eviction == MaxRectsEviction::Thinnest));
+			CHECK(hasThinnest == (eviction == MaxRectsEviction::SmallestArea));
+		}
+	}
+}
+
+TEST_CASE("Bin Selection", "[BinSelection]") {
+	const BinSelection selections[] = { BinSelection::GlobalBest, BinSelection::FirstFit, BinSelection::BestFit, BinSelection::LastFit };
+
+	for (auto selection : selections) {
+		for (auto i = 0u; i < 25; ++i) {
+			auto guillotineRects = prepareVector(i);
+			auto maxRectsRects = guillotineRects;
+
+			auto guillotineConfig = makeGuillotineConfig(30, 30, 3, UnlimitedBins, true, true, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+			guillotineConfig.binSelection = selection;
+
+			auto maxRectsConfig = makeMaxRectsConfig(30, 30, 3, UnlimitedBins, true, MaxRectsHeuristic::BestShortSideFit);
+			maxRectsConfig.binSelection = selection;
+
+			validateRects(packGuillotine(guillotineConfig, guillotineRects), guillotineRects, 30, 30);
+			validateRects(packMaxRects(maxRectsConfig, maxRectsRects), maxRectsRects, 30, 30);
+		}
+	}
+}
+
+TEST_CASE("Bin Selection First And Last Fit", "[BinSelection]") {
+	std::vector<BinRect> rects { { { 0, 0, 5, 5 }, InvalidBin, false } };
+
+	auto config = makeMaxRectsConfig(10, 10, 3, UnlimitedBins, false, MaxRectsHeuristic::BestAreaFit);
+
+	config.binSelection = BinSelection::FirstFit;
+	packMaxRects(config, rects);
+	CHECK(rects[0].bin == 0);
+
+	config.binSelection = BinSelection::LastFit;
+	packMaxRects(config, rects);
+	CHECK(rects[0].bin == 2);
+}
+
+TEST_CASE("Bin Selection Best Fit", "[BinSelection]") {
+	// The middle bin has the least space left, the first one the most
+	const Rect occupied[] = { { 0, 0, 10, 2 }, { 0, 0, 10, 6 }, { 0, 0, 10, 4 } };
+	std::vector<BinRect> none;
+
+	SECTION("MaxRects") {
+		auto config = makeMaxRectsConfig(10, 10, 1, UnlimitedBins, false, MaxRectsHeuristic::BestAreaFit);
+		config.binSelection = BinSelection::BestFit;
+
+		Internal::MaxRectsState state {};
+
+		for (auto i = 0u; i < 3; ++i)
+			REQUIRE(Internal::MaxRects<std::vector<BinRect>::iterator>(none.begin(), none.end(), 0, config).occupy(state, i, occupied[i]));
+
+		std::vector<BinRect> rects { { { 0, 0, 5, 3 }, InvalidBin, false } };
+		REQUIRE(Internal::MaxRects<std::vector<BinRect>::iterator>(rects.begin(), rects.end(), 0, config).pack(state));
+		CHECK(rects[0].bin == 1);
+	}
+
+	SECTION("Guillotine") {
+		auto config = makeGuillotineConfig(10, 10, 1, UnlimitedBins, false, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+		config.binSelection = BinSelection::BestFit;
+
+		Internal::GuillotineState state {};
+
+		for (auto i = 0u; i < 3; ++i)
+			REQUIRE(Internal::Guillotine<std::vector<BinRect>::iterator>(none.begin(), none.end(), 0, config).occupy(state, i, occupied[i]));
+
+		std::vector<BinRect> rects { { { 0, 0, 5, 3 }, InvalidBin, false } };
+		REQUIRE(Internal::Guillotine<std::vector<BinRect>::iterator>(rects.begin(), rects.end(), 0, config).pack(state));
+		CHECK(rects[0].bin == 1);
+	}
+}
+
+TEST_CASE("Peak Memory", "[MaxRects][Guillotine]") {
+	for (auto i = 0u; i < 25; ++i) {
+		auto guillotineRects = prepareVector(i);
+		auto maxRectsRects = guillotineRects;
+
+		auto guillotineConfig = makeGuillotineConfig(20, 20, 1, UnlimitedBins, true, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+
+		auto maxRectsConfig = makeMaxRectsConfig(20, 20, 1, UnlimitedBins, true, MaxRectsHeuristic::ContactPointRule);
+
+		const auto guillotineResult = packGuillotine(guillotineConfig, guillotineRects);
+		const auto maxRectsResult = packMaxRects(maxRectsConfig, maxRectsRects);
+
+		validateRects(guillotineResult, guillotineRects, 20, 20);
+		validateRects(maxRectsResult, maxRectsRects, 20, 20);
+		CHECK(guillotineResult.peakMemory > 0);
+		CHECK(maxRectsResult.peakMemory > 0);
+	}
+}
+
+TEST_CASE("Peak Memory Closed Bins", "[MaxRects][Guillotine]") {
+	for (auto i = 0u; i < 25; ++i) {
+		auto closedGuillotineRects = prepareVector(i);
+		auto openGuillotineRects = closedGuillotineRects;
+		auto closedMaxRectsRects = closedGuillotineRects;
+		auto openMaxRectsRects = closedGuillotineRects;
+
+		auto guillotineConfig = makeGuillotineConfig(20, 20, 1, UnlimitedBins, true, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+		auto maxRectsConfig = makeMaxRectsConfig(20, 20, 1, UnlimitedBins, true, MaxRectsHeuristic::BestAreaFit);
+
+		// Bins are closed whenever a new one is added
+		const auto closedGuillotine = packGuillotine(guillotineConfig, closedGuillotineRects);
+		const auto closedMaxRects = packMaxRects(maxRectsConfig, closedMaxRectsRects);
+
+		REQUIRE(closedGuillotine.numBins > 1);
+		REQUIRE(closedMaxRects.numBins > 1);
+
+		// The minimum number of bins are all open from the start and stay open
+		guillotineConfig.minBins = (int) closedGuillotine.numBins;
+		maxRectsConfig.minBins = (int) closedMaxRects.numBins;
+
+		const auto openGuillotine = packGuillotine(guillotineConfig, openGuillotineRects);
+		const auto openMaxRects = packMaxRects(maxRectsConfig, openMaxRectsRects);
+
+		CHECK(closedGuillotine.peakMemory < openGuillotine.peakMemory);
+		CHECK(closedMaxRects.peakMemory < openMaxRects.peakMemory);
+	}
+}
+
+TEST_CASE("Layout Too Big Exception", "[MaxRects]") {
+	auto config = makeMaxRectsConfig(20, 20, 1, UnlimitedBins, false, MaxRectsHeuristic::BestAreaFit);
+	config.borderPadding = 1;
+	std::vector<BinRect> rects { { { 0, 0, 19, 10 }, InvalidBin, false } };
+
+	CHECK_THROWS(packMaxRects(config, rects));
+	config.borderPadding = 0;
+	CHECK_NOTHROW(packMaxRects(config, rects));
+}
+
+TEST_CASE("Exact", "[Exact]") {
+	const auto seed = 0u;
+
+	for (auto i = 0u; i < 25; ++i)
+		testExact(seed + i);
+}
+
+TEST_CASE("Exact Optimal", "[Exact]") {
+	// Two 10x10 bins cut into pieces: 4x10, 6x2 and 6x8 fill the first one, 10x6, 10x2, 5x2 and 5x2 the second one
+	std::vector<BinRect> rects {
+		{ { 0, 0, 4, 10 }, 0, false }, { { 0, 0, 6, 2 }, 0, false }, { { 0, 0, 6, 8 }, 0, false },
+		{ { 0, 0, 10, 6 }, 0, false }, { { 0, 0, 10, 2 }, 0, false }, { { 0, 0, 5, 2 }, 0, false },
+		{ { 0, 0, 5, 2 }, 0, false }
+	};
+
+	const MaxRectsHeuristic heuristics[] = {
+		MaxRectsHeuristic::BestShortSideFit, MaxRectsHeuristic::BestLongSideFit, MaxRectsHeuristic::BestAreaFit,
+		MaxRectsHeuristic::BottomLeftRule
+	};
+
+	// Every greedy solution, which the search starts from, needs a third bin
+	for (auto heuristic : heuristics) {
+		auto greedyRects = rects;
+		auto greedyConfig = makeMaxRectsConfig(10, 10, 1, UnlimitedBins, false, heuristic);
+		REQUIRE(packMaxRects(greedyConfig, greedyRects).numBins == 3);
+	}
+
+	ExactConfiguration config { 10, 10, 1, UnlimitedBins, false, 0, 0 };
+	const auto result = packExact(config, rects);
+
+	REQUIRE_FALSE(result.failed);
+	CHECK(result.numBins == 2);
+	validateRects(result, rects, 10, 10);
+}
+
+TEST_CASE("Exact Failed", "[Exact]") {
+	const auto seed = 0u;
+	auto rects = prepareVector(seed, 10);
+
+	ExactConfiguration config { 20, 20, 1, 1, false, 1000, 0 };
+	REQUIRE(packExact(config, rects).failed);
+
+	CHECK(!std::any_of(rects.begin(), rects.end(), [](const BinRect& rect) {
+		return rect.bin != 0 && rect.bin != InvalidBin;
+	}));
+}
+
+TEST_CASE("Minimum Size Square", "[MinimumSize]") {
+	std::vector<BinRect> rects(4, { { 0, 0, 10, 10 }, 0, false });
+
+	auto config = makeMaxRectsConfig(0, 0, 1, 1, false, MaxRectsHeuristic::BestAreaFit);
+	SizeSearchConfiguration search { 100, 100, false, true, 0, 0 };
+
+	const auto result = packMinimumSize(config, search, rects);
+
+	REQUIRE_FALSE(result.failed);
+	CHECK(config.width == 20);
+	CHECK(config.height == 20);
+	validateRects(result, rects, 20, 20);
+}
+
+TEST_CASE("Minimum Size Power Of Two", "[MinimumSize]") {
+	const auto seed = 0u;
+	auto rects = prepareVector(seed);
+
+	auto config = makeGuillotineConfig(0, 0, 1, 1, true, true, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MaximizeArea);
+	SizeSearchConfiguration search { 256, 256, true, false, 2, 0 };
+
+	const auto result = packMinimumSize(config, search, rects);
+
+	REQUIRE_FALSE(result.failed);
+	CHECK((config.width & (config.width - 1)) == 0);
+	CHECK((config.height & (config.height - 1)) == 0);
+	CHECK(std::max(config.width, config.height) <= 2 * std::min(config.width, config.height));
+	validateRects(result, rects, config.width, config.height);
+}
+
+TEST_CASE("Minimum Size Failed", "[MinimumSize]") {
+	std::vector<BinRect> rects(4, { { 0, 0, 10, 10 }, 0, false });
+
+	auto config = makeMaxRectsConfig(0, 0, 1, 1, false, MaxRectsHeuristic::BestAreaFit);
+	SizeSearchConfiguration search { 15, 30, false, false, 0, 0 };
+
+	CHECK(packMinimumSize(config, search, rects).failed);
+	CHECK(config.width == 15);
+	CHECK(config.height == 30);
+}
+
+TEST_CASE("Minimum Size Too Large", "[MinimumSize]") {
+	// The last rectangle doesn't fit into the maximum size, the others would
+	std::vector<BinRect> rects { { { 0, 0, 5, 5 }, 0, false }, { { 0, 0, 5, 5 }, 0, false }, { { 0, 0, 40, 5 }, 0, false } };
+
+	auto config = makeMaxRectsConfig(0, 0, 2, 3, false, MaxRectsHeuristic::BestAreaFit);
+	SizeSearchConfiguration search { 20, 20, false, false, 0, 0 };
+
+	CHECK(packMinimumSize(config, search, rects).failed);
+	CHECK(config.minBins == 2);
+	CHECK(config.maxBins == 3);
+	CHECK(std::all_of(rects.begin(), rects.end(), [](const BinRect& rect) { return rect.bin == InvalidBin; }));
+}
+
+TEST_CASE("Binary Format", "[BinaryFormat]") {
+	const auto path = "RectBinPackTest.bin";
+	auto rects = prepareVector(0);
+
+	writeBinaryFile(path, rects);
+
+	auto config = makeMaxRectsConfig(64, 64, 1, UnlimitedBins, true, MaxRectsHeuristic::BestAreaFit);
+
+	{
+		MappedBinaryFile file(path);
+		REQUIRE(file.size() == rects.size());
+		CHECK(file[3].width == rects[3].rect.width);
+		CHECK(file[3].bin == InvalidBin);
+
+		packMaxRects(config, file);
+	}
+
+	const auto result = packMaxRects(config, rects);
+
+	MappedBinaryFile file(path);
+	REQUIRE(file.size() == rects.size());
+
+	for (auto i = 0u; i < rects.size(); ++i) {
+		CHECK(toRect(file[i]) == rects[i].rect);
+		CHECK(file[i].bin == rects[i].bin);
+		CHECK(((file[i].flags & BinaryFlipped) != 0) == rects[i].flipped);
+	}
+
+	validateRects(result, rects, config.width, config.height);
+	std::remove(path);
+}
+
+TEST_CASE("Binary Format Invalid", "[BinaryFormat]") {
+	alignas(8) char data[64] = "RBPK";
+
+	CHECK_THROWS_AS(BinaryView(data, 8), BinaryFormatError);
+	CHECK_THROWS_AS(BinaryView(data, sizeof(data)), BinaryFormatError);
+	CHECK_THROWS_AS(MappedBinaryFile("RectBinPackMissing.bin"), BinaryFormatError);
+}
+
+#ifdef ENABLE_COMPOSITOR
+static void testCompositor(unsigned int pixelSize, unsigned int seed) {
+	auto rects = prepareVector(seed);
+
+	// Sizes above 16 pixels make use of several transpose blocks and row copies
+	for (auto& rect : rects) {
+		rect.rect.width *= 3;
+		rect.rect.height *= 2;
+	}
+
+	auto config = makeMaxRectsConfig(80, 80, 1, UnlimitedBins, true, MaxRectsHeuristic::BestShortSideFit);
+	const auto original = rects;
+	const auto result = packMaxRects(config, rects);
+
+	std::vector<std::vector<unsigned char>> pixels;
+	std::vector<SourceImage> sources;
+
+	for (auto i = 0u; i < original.size(); ++i) {
+		const auto& rect = original[i].rect;
+		pixels.emplace_back(rect.width * rect.height * pixelSize);
+
+		for (auto j = 0u; j < pixels.back().size(); ++j)
+			pixels.back()[j] = (unsigned char) (i * 31 + j);
+
+		sources.push_back({ pixels.back().data(), rect.width, rect.height, rect.width * pixelSize });
+	}
+
+	std::vector<std::vector<unsigned char>> binPixels(result.numBins, std::vector<unsigned char>(config.width * config.height * pixelSize));
+	std::vector<BinImage> bins;
+
+	for (auto& bin : binPixels)
+		bins.push_back({ bin.data(), config.width, config.height, config.width * pixelSize });
+
+	composite(CompositorConfiguration { pixelSize, 2 }, rects, sources, bins);
+
+	for (auto i = 0u; i < rects.size(); ++i) {
+		const auto& rect = rects[i];
+
+		for (auto y = 0u; y < rect.rect.height; ++y) {
+			for (auto x = 0u; x < rect.rect.width; ++x) {
+				const auto srcX = rect.flipped ? y : x;
+				const auto srcY = rect.flipped ? x : y;
+				const auto src = pixels[i].data() + (srcY * sources[i].width + srcX) * pixelSize;
+				const auto dst = binPixels[rect.bin].data() + ((rect.rect.y + y) * config.width + rect.rect.x + x) * pixelSize;
+
+				REQUIRE(std::equal(src, src + pixelSize, dst));
+			}
+		}
+	}
+}
+
+TEST_CASE("Compositor", "[Compositor]") {
+	for (auto i = 0u; i < 5; ++i) {
+		testCompositor(1, i);
+		testCompositor(3, i);
+		testCompositor(4, i);
+		testCompositor(5, i);
+	}
+}
+
+TEST_CASE("Compositor Mismatch Exception", "[Compositor]") {
+	unsigned char pixels[16] {};
+
+	const std::vector<BinRect> rects { { { 0, 0, 2, 2 }, 0, false } };
+	const std::vector<SourceImage> sources { { pixels, 2, 1, 2 } };
+	const std::vector<BinImage> bins { { pixels, 4, 4, 4 } };
+
+	CHECK_THROWS_AS(composite(CompositorConfiguration { 1, 1 }, rects, sources, bins), CompositorError);
+	CHECK_THROWS_AS(composite(CompositorConfiguration { 1, 1 }, rects, std::vector<SourceImage>(), bins), CompositorError);
+}
+
+TEST_CASE("Compositor Empty", "[Compositor]") {
+	const std::vector<BinRect> rects;
+	const std::vector<SourceImage> sources;
+
+	CHECK_NOTHROW(composite(CompositorConfiguration { 1, 0 }, rects, sources, std::vector<BinImage>()));
+}
+#endif
+
+TEST_CASE("Cache Memory", "[Cache]") {
+	MemoryCacheStore store(2);
+	auto config = makeMaxRectsConfig(32, 32, 1, UnlimitedBins, true, MaxRectsHeuristic::BestShortSideFit);
+
+	auto expected = prepareVector(0);
+	const auto expectedResult = packMaxRects(config, expected);
+
+	for (auto i = 0u; i < 2; ++i) {
+		auto rects = prepareVector(0);
+		const auto result = packCached(store, config, rects);
+
+		CHECK(result.failed == expectedResult.failed);
+		CHECK(result.numBins == expectedResult.numBins);
+		CHECK(store.size() == 1);
+
+		for (auto j = 0u; j < rects.size(); ++j) {
+			CHECK(rects[j].rect == expected[j].rect);
+			CHECK(rects[j].bin == expected[j].bin);
+			CHECK(rects[j].flipped == expected[j].flipped);
+		}
+	}
+
+	// Every option is part of the key
+	auto rects = prepareVector(0);
+	config.spacing = 1;
+	packCached(store, config, rects);
+	CHECK(store.size() == 2);
+
+	// The least recently used entry is dropped
+	auto guillotineConfig = makeGuillotineConfig(32, 32, 1, UnlimitedBins, true, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+	rects = prepareVector(1);
+	packCached(store, guillotineConfig, rects);
+	CHECK(store.size() == 2);
+}
+
+TEST_CASE("Cache Directory", "[Cache]") {
+	auto config = makeGuillotineConfig(32, 32, 1, UnlimitedBins, true, true, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+
+	auto expected = prepareVector(2);
+	const auto expectedResult = packGuillotine(config, expected);
+
+	DirectoryCacheStore store(".");
+	auto rects = prepareVector(2);
+	const auto key = getCacheKey(config, rects.begin(), rects.end());
+
+	packCached(store, config, rects);
+
+	CacheEntry entry;
+	REQUIRE(DirectoryCacheStore(".").load(key, entry));
+	CHECK(entry.result.numBins == expectedResult.numBins);
+	REQUIRE(entry.rects.size() == expected.size());
+
+	for (auto i = 0u; i < expected.size(); ++i) {
+		CHECK(entry.rects[i].rect == expected[i].rect);
+		CHECK(entry.rects[i].bin == expected[i].bin);
+		CHECK(entry.rects[i].flipped == expected[i].flipped);
+	}
+
+	std::remove(store.path(key).c_str());
+}
+
+namespace {
+	/// Memory store which counts how often entries are stored
+	class CountingCacheStore: public MemoryCacheStore {
+	public:
+		CountingCacheStore():
+			MemoryCacheStore(4) { }
+
+		void store(std::uint64_t key, const CacheEntry& entry) override {
+			++stores;
+			MemoryCacheStore::store(key, entry);
+		}
+
+		unsigned int stores = 0;
+	};
+}
+
+TEST_CASE("Cache Empty Rectangles", "[Cache]") {
+	CountingCacheStore store;
+	auto config = makeMaxRectsConfig(32, 32, 1, UnlimitedBins, true, MaxRectsHeuristic::BestShortSideFit);
+
+	for (auto i = 0u; i < 2; ++i) {
+		std::vector<BinRect> rects {
+			{ { 0, 0, 4, 5 }, InvalidBin, false },
+			{ { 0, 0, 0, 5 }, InvalidBin, false },
+			{ { 0, 0, 3, 0 }, InvalidBin, false }
+		};
+
+		validateRects(packCached(store, config, rects), rects, 32, 32);
+		CHECK(rects[1].bin == InvalidBin);
+		CHECK(rects[2].bin == InvalidBin);
+	}
+
+	// The second run is a hit
+	CHECK(store.stores == 1);
+}
+
+TEST_CASE("Cache Directory Corrupt Entry", "[Cache]") {
+	DirectoryCacheStore store(".");
+	const std::uint64_t key = 0x5eed;
+
+	{
+		// Valid header (version, failed, number of bins, count) claiming far more records than the file holds
+		std::ofstream stream(store.path(key), std::ios::binary);
+		const unsigned char header[] { 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0, 0 };
+
+		stream.write("RBPC", 4);
+		stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+	}
+
+	CacheEntry entry;
+	CHECK_FALSE(store.load(key, entry));
+
+	{
+		// Entries are little endian regardless of the platform
+		std::ofstream stream(store.path(key), std::ios::binary);
+		const unsigned char data[] {
+			1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
+			2, 0, 0, 0, 0, 1, 0, 0, 4, 0, 0, 0, 5, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0
+		};
+
+		stream.write("RBPC", 4);
+		stream.write(reinterpret_cast<const char*>(data), sizeof(data));
+	}
+
+	REQUIRE(store.load(key, entry));
+	CHECK(entry.result.numBins == 1);
+	REQUIRE(entry.rects.size() == 1);
+	CHECK(entry.rects[0].rect == Rect { 2, 256, 4, 5 });
+	CHECK(entry.rects[0].bin == 0);
+	CHECK(entry.rects[0].flipped);
+
+	std::remove(store.path(key).c_str());
+}
+
+template<typename Packer>
+static void testPacker(const Packer& initial, unsigned int seed) {
+	auto packer = initial;
+	std::vector<BinRect> all;
+
+	for (auto i = 0u; i < 3; ++i) {
+		auto rects = prepareVector(seed + i);
+		const auto result = packer.insert(rects);
+
+		CHECK(result.numBins == packer.numBins());
+		all.insert(all.end(), rects.begin(), rects.end());
+		validateRects({ false, packer.numBins(), 0 }, all, packer.configuration().width, packer.configuration().height);
+	}
+
+	// A restored packer continues exactly like the original one
+	auto restored = Packer::load(packer.save());
+	auto rects = prepareVector(seed + 3);
+	auto restoredRects = rects;
+
+	const auto result = packer.insert(rects);
+	const auto restoredResult = restored.insert(restoredRects);
+
+	CHECK(result.numBins == restoredResult.numBins);
+
+	for (auto i = 0u; i < rects.size(); ++i) {
+		CHECK(rects[i].rect == restoredRects[i].rect);
+		CHECK(rects[i].bin == restoredRects[i].bin);
+	}
+
+	CHECK(packer.save() == restored.save());
+}
+
+TEST_CASE("MaxRects Packer", "[Packer]") {
+	for (auto i = 0u; i < 5; ++i) {
+		testPacker(MaxRectsPacker(makeMaxRectsConfig(40, 40, 1, UnlimitedBins, true, MaxRectsHeuristic::BestShortSideFit)), i);
+		testPacker(MaxRectsPacker(makeMaxRectsConfig(40, 40, 1, UnlimitedBins, false, MaxRectsHeuristic::ContactPointRule)), i);
+	}
+}
+
+TEST_CASE("Guillotine Packer", "[Packer]") {
+	for (auto i = 0u; i < 5; ++i) {
+		testPacker(GuillotinePacker(makeGuillotineConfig(40, 40, 1, UnlimitedBins, true, true, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea)), i);
+		testPacker(GuillotinePacker(makeGuillotineConfig(40, 40, 1, UnlimitedBins, false, false, GuillotineRectHeuristic::BestShortSideFit, GuillotineSplitHeuristic::ShorterAxis)), i);
+
+		auto sequential = makeGuillotineConfig(40, 40, 1, UnlimitedBins, true, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+		sequential.sequential = true;
+		testPacker(GuillotinePacker(sequential), i);
+	}
+}
+
+TEST_CASE("Packer Parked Space", "[Packer]") {
+	// The space left next to the first rectangle is too small for it, so it's parked while packing
+	std::vector<BinRect> first { { { 0, 0, 6, 10 }, InvalidBin, false } };
+	std::vector<BinRect> second { { { 0, 0, 4, 10 }, InvalidBin, false } };
+
+	MaxRectsPacker maxRects(makeMaxRectsConfig(10, 10, 1, UnlimitedBins, false, MaxRectsHeuristic::BestAreaFit));
+	maxRects.insert(first);
+	CHECK_FALSE(maxRects.insert(second).failed);
+	CHECK(maxRects.numBins() == 1);
+	CHECK(second[0].bin == 0);
+
+	GuillotinePacker guillotine(makeGuillotineConfig(10, 10, 1, UnlimitedBins, false, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea));
+	guillotine.insert(first);
+	CHECK_FALSE(guillotine.insert(second).failed);
+	CHECK(guillotine.numBins() == 1);
+	CHECK(second[0].bin == 0);
+}
+
+TEST_CASE("Packer Invalid State", "[Packer]") {
+	const auto state = MaxRectsPacker(makeMaxRectsConfig(40, 40, 1, UnlimitedBins, true, MaxRectsHeuristic::BestShortSideFit)).save();
+
+	CHECK_THROWS_AS(GuillotinePacker::load(state), PackerStateError);
+	CHECK_THROWS_AS(MaxRectsPacker::load(state.data(), state.size() - 1), PackerStateError);
+	CHECK_THROWS_AS(MaxRectsPacker::load(std::vector<unsigned char>(4)), PackerStateError);
+
+	// The heuristic follows the header, the sizes, the bin limits and canFlip
+	auto heuristic = state;
+	heuristic[29] = 5;
+	CHECK_THROWS_AS(MaxRectsPacker::load(heuristic), PackerStateError);
+
+	std::vector<BinRect> rects { { { 0, 0, 30, 30 }, InvalidBin, false } };
+	GuillotinePacker guillotine(makeGuillotineConfig(40, 40, 1, UnlimitedBins, false, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea));
+	guillotine.insert(rects);
+
+	// Both heuristics follow canFlip and merge
+	auto rectHeuristic = guillotine.save();
+	rectHeuristic[30] = 6;
+	CHECK_THROWS_AS(GuillotinePacker::load(rectHeuristic), PackerStateError);
+
+	auto splitHeuristic = guillotine.save();
+	splitHeuristic[34] = 6;
+	CHECK_THROWS_AS(GuillotinePacker::load(splitHeuristic), PackerStateError);
+
+	// Shrinking the bin leaves the packed rectangle outside of it
+	auto outside = guillotine.save();
+	outside[12] = 20;
+	CHECK_THROWS_AS(GuillotinePacker::load(outside), PackerStateError);
+	CHECK_NOTHROW(GuillotinePacker::load(guillotine.save()));
+}
+
+template<typename Configuration, typename Pack, typename Repack>
+static void testRepack(const Configuration& config, unsigned int seed, Pack pack, Repack repack) {
+	const auto original = prepareVector(seed);
+	auto previous = original;
+	pack(config, previous);
+
+	// Change the size of a few rectangles and add new ones
+	auto rects = original;
+	auto hints = previous;
+
+	rects[3].rect.width = 7;
+	rects[3].rect.height = 9;
+	rects[8].rect.width += 1;
+
+	for (auto i = 0u; i < 3; ++i) {
+		rects.push_back({ { 0, 0, 5 + i, 4 }, 0, false });
+		hints.push_back({ { 0, 0, 0, 0 }, InvalidBin, false });
+	}
+
+	auto result = rects;
+	const auto repackResult = repack(config, result, hints);
+
+	validateRects(repackResult, result, config.width, config.height);
+	validateLayout(result, config.width, config.height, config.borderPadding, config.spacing, std::max(1u, config.alignment));
+
+	for (auto i = 0u; i < original.size(); ++i) {
+		if (i == 3 || i == 8 || previous[i].bin == InvalidBin)
+			continue;
+
+		CHECK(result[i].rect == previous[i].rect);
+		CHECK(result[i].bin == previous[i].bin);
+		CHECK(result[i].flipped == previous[i].flipped);
+	}
+}
+
+TEST_CASE("MaxRects Repack", "[Repack]") {
+	for (auto i = 0u; i < 10; ++i) {
+		auto config = makeMaxRectsConfig(40, 40, 1, UnlimitedBins, i % 2 == 0, MaxRectsHeuristic::BestAreaFit);
+		config.borderPadding = i % 3;
+		config.spacing = i % 2;
+		config.alignment = 1 + i % 3;
+
+		testRepack(config, i, [](const MaxRectsConfiguration& c, std::vector<BinRect>& r) {
+			return packMaxRects(c, r);
+		}, [](const MaxRectsConfiguration& c, std::vector<BinRect>& r, const std::vector<BinRect>& h) {
+			return repackMaxRects(c, r, h);
+		});
+	}
+}
+
+TEST_CASE("Guillotine Repack", "[Repack]") {
+	for (auto i = 0u; i < 10; ++i) {
+		auto config = makeGuillotineConfig(40, 40, 1, UnlimitedBins, i % 2 == 0, i % 4 < 2, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+		config.borderPadding = i % 3;
+		config.spacing = i % 2;
+		config.alignment = 1 + i % 3;
+
+		testRepack(config, i, [](const GuillotineConfiguration& c, std::vector<BinRect>& r) {
+			return packGuillotine(c, r);
+		}, [](const GuillotineConfiguration& c, std::vector<BinRect>& r, const std::vector<BinRect>& h) {
+			return repackGuillotine(c, r, h);
+		});
+	}
+}
+
+TEST_CASE("Repack Fallback", "[Repack]") {
+	auto config = makeMaxRectsConfig(10, 10, 1, 1, false, MaxRectsHeuristic::BestAreaFit);
+
+	// The kept rectangle blocks the space for the new one, so everything is packed again
+	std::vector<BinRect> rects { { { 0, 0, 5, 5 }, 0, false }, { { 0, 0, 10, 5 }, 0, false } };
+	const std::vector<BinRect> hints { { { 3, 3, 5, 5 }, 0, false }, { { 0, 0, 0, 0 }, InvalidBin, false } };
+
+	const auto result = repackMaxRects(config, rects, hints);
+
+	CHECK_FALSE(result.failed);
+	CHECK(rects[0].rect.y != 3);
+	validateRects(result, rects, config.width, config.height);
+}
+
+TEST_CASE("Repack Stale Hints", "[Repack]") {
+	// Neither hint is kept, one points far beyond the previous layout and one hits the obstacle of a new bin
+	const std::vector<BinRect> hints {
+		{ { 5, 5, 5, 5 }, 1000000, false },
+		{ { 0, 0, 5, 5 }, 3, false },
+		{ { 0, 0, 0, 0 }, InvalidBin, false },
+		{ { 0, 0, 0, 0 }, InvalidBin, false }
+	};
+
+	auto maxRectsConfig = makeMaxRectsConfig(10, 10, 1, UnlimitedBins, false, MaxRectsHeuristic::BestAreaFit);
+	maxRectsConfig.obstacles = { { 0, 0, 5, 5 } };
+	auto guillotineConfig = makeGuillotineConfig(10, 10, 1, UnlimitedBins, false, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+	guillotineConfig.obstacles = { { 0, 0, 5, 5 } };
+
+	for (auto guillotine : { false, true }) {
+		std::vector<BinRect> rects {
+			{ { 0, 0, 5, 5 }, InvalidBin, false },
+			{ { 0, 0, 5, 5 }, InvalidBin, false },
+			{ { 0, 0, 1, 1 }, InvalidBin, false },
+			{ { 0, 0, 1, 1 }, InvalidBin, false }
+		};
+
+		const auto result = guillotine ? repackGuillotine(guillotineConfig, rects, hints) : repackMaxRects(maxRectsConfig, rects, hints);
+
+		validateRects(result, rects, 10, 10);
+		CHECK(result.numBins == 1);
+	}
+}
+
+static void validateObstacles(const std::vector<BinRect>& rects, const std::vector<Rect>& obstacles, unsigned int spacing) {
+	for (auto& rect : rects) {
+		if (rect.bin == InvalidBin)
+			continue;
+
+		const Rect spaced { rect.rect.x, rect.rect.y, rect.rect.width + spacing, rect.rect.height + spacing };
+
+		for (auto& obstacle : obstacles) {
+			const Rect obstacleSpaced { obstacle.x, obstacle.y, obstacle.width + spacing, obstacle.height + spacing };
+
+			REQUIRE(!spaced.intersect(obstacle));
+			REQUIRE(!obstacleSpaced.intersect(rect.rect));
+		}
+	}
+}
+
+TEST_CASE("MaxRects Obstacles", "[MaxRects]") {
+	const std::vector<Rect> obstacles { { 0, 0, 1, 1 }, { 30, 10, 8, 6 }, { 32, 12, 6, 10 } };
+
+	for (auto i = 0u; i < 25; ++i) {
+		auto rects = prepareVector(i);
+		auto config = makeMaxRectsConfig(40, 40, 1, UnlimitedBins, i % 2 == 0, (MaxRectsHeuristic) (i % 5));
+		config.borderPadding = i % 2;
+		config.spacing = i % 3;
+		config.obstacles = obstacles;
+
+		const auto result = packMaxRects(config, rects);
+
+		validateRects(result, rects, config.width, config.height);
+		validateObstacles(rects, obstacles, config.spacing);
+	}
+}
+
+TEST_CASE("Guillotine Obstacles", "[Guillotine]") {
+	const std::vector<Rect> obstacles { { 0, 0, 1, 1 }, { 30, 10, 8, 6 }, { 32, 12, 6, 10 } };
+
+	for (auto i = 0u; i < 25; ++i) {
+		auto rects = prepareVector(i);
+		auto config = makeGuillotineConfig(40, 40, 1, UnlimitedBins, i % 2 == 0, i % 4 < 2, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+		config.borderPadding = i % 2;
+		config.spacing = i % 3;
+		config.obstacles = obstacles;
+
+		const auto result = packGuillotine(config, rects);
+
+		validateRects(result, rects, config.width, config.height);
+		validateObstacles(rects, obstacles, config.spacing);
+	}
+}
+
+TEST_CASE("Obstacles Too Big Exception", "[MaxRects]") {
+	std::vector<BinRect> rects { { { 0, 0, 10, 10 }, 0, false } };
+	auto config = makeMaxRectsConfig(20, 20, 1, UnlimitedBins, false, MaxRectsHeuristic::BestAreaFit);
+	config.obstacles = { { 5, 5, 10, 10 } };
+
+	CHECK_THROWS_AS(packMaxRects(config, rects), RectangleTooLargeError);
+}
+
+static void validateBinTypes(const BinTypeResult& result, const std::vector<BinRect>& rects, const std::vector<BinType>& types) {
+	REQUIRE(result.binTypes.size() == result.numBins);
+
+	auto cost = 0.0;
+
+	for (auto type = 0u; type < types.size(); ++type) {
+		const auto count = std::count(result.binTypes.begin(), result.binTypes.end(), type);
+
+		if (types[type].maxCount > 0)
+			CHECK(count <= types[type].maxCount);
+
+		cost += count * types[type].cost;
+	}
+
+	CHECK(result.cost == Approx(cost));
+
+	for (auto bin = 0u; bin < result.numBins; ++bin) {
+		std::vector<BinRect> binRects;
+
+		for (auto& rect : rects)
+			if (rect.bin == bin)
+				binRects.push_back({ rect.rect, 0, rect.flipped });
+
+		const auto& type = types[result.binTypes[bin]];
+		validateRects({ false, 1, 0 }, binRects, type.width, type.height);
+	}
+}
+
+TEST_CASE("Bin Types", "[BinTypes]") {
+	const std::vector<BinType> types { { 40, 40, 4, UnlimitedBins }, { 20, 20, 1.5, 3 } };
+
+	for (auto i = 0u; i < 10; ++i) {
+		auto rects = prepareVector(i);
+		auto config = makeMaxRectsConfig(0, 0, 1, 1, true, MaxRectsHeuristic::BestShortSideFit);
+
+		const auto result = packBinTypes(config, types, rects);
+
+		REQUIRE_FALSE(result.failed);
+		validateBinTypes(result, rects, types);
+		CHECK(std::none_of(rects.begin(), rects.end(), [](const BinRect& rect) {
+			return rect.bin == InvalidBin && rect.rect.width > 0 && rect.rect.height > 0;
+		}));
+	}
+}
+
+TEST_CASE("Bin Types Remnant", "[BinTypes]") {
+	const std::vector<BinType> types { { 20, 20, 4, UnlimitedBins }, { 10, 10, 1, UnlimitedBins } };
+	std::vector<BinRect> rects { { { 0, 0, 20, 20 }, 0, false }, { { 0, 0, 5, 5 }, 0, false } };
+
+	auto config = makeGuillotineConfig(0, 0, 1, 1, false, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+	const auto result = packBinTypes(config, types, rects);
+
+	// The large rectangle fills the large bin, the small one goes into a small bin
+	REQUIRE_FALSE(result.failed);
+	CHECK(result.binTypes == std::vector<std::size_t> { 0, 1 });
+	CHECK(result.cost == Approx(5));
+	validateBinTypes(result, rects, types);
+}
+
+TEST_CASE("Bin Types Failed", "[BinTypes]") {
+	const std::vector<BinType> types { { 20, 20, 1, 1 } };
+	std::vector<BinRect> rects { { { 0, 0, 20, 20 }, 0, false }, { { 0, 0, 5, 5 }, 0, false }, { { 0, 0, 30, 5 }, 0, false } };
+
+	auto config = makeMaxRectsConfig(0, 0, 1, 1, false, MaxRectsHeuristic::BestAreaFit);
+	const auto result = packBinTypes(config, types, rects);
+
+	CHECK(result.failed);
+	CHECK(result.numBins == 1);
+	CHECK(rects[0].bin == 0);
+	CHECK(rects[1].bin == InvalidBin);
+	CHECK(rects[2].bin == InvalidBin);
+}
+
+TEST_CASE("Bin Types Obstacles", "[BinTypes]") {
+	const std::vector<BinType> types { { 20, 20, 1, 1 } };
+
+	// The obstacle leaves a 20x10 strip, which can't take the large rectangle but both small ones
+	const auto check = [&](std::vector<BinRect> rects, const BinTypeResult& result) {
+		CHECK(result.failed);
+		CHECK(result.numBins == 1);
+		CHECK(rects[0].bin == InvalidBin);
+		CHECK(rects[1].bin == 0);
+		CHECK(rects[2].bin == 0);
+	};
+
+	const std::vector<BinRect> original { { { 0, 0, 15, 15 }, 0, false }, { { 0, 0, 10, 10 }, 0, false }, { { 0, 0, 10, 10 }, 0, false } };
+
+	SECTION("MaxRects") {
+		auto rects = original;
+		auto config = makeMaxRectsConfig(0, 0, 1, 1, false, MaxRectsHeuristic::BestAreaFit);
+		config.obstacles = { { 0, 10, 20, 10 } };
+		check(rects, packBinTypes(config, types, rects));
+	}
+
+	SECTION("Guillotine") {
+		auto rects = original;
+		auto config = makeGuillotineConfig(0, 0, 1, 1, false, false, GuillotineRectHeuristic::BestAreaFit, GuillotineSplitHeuristic::MinimizeArea);
+		config.obstacles = { { 0, 10, 20, 10 } };
+		check(rects, packBinTypes(config, types, rects));
+	}
+}
+
+TEST_CASE("Validate", "[Validate]") {
+	std::vector<BinRect> originals { { { 0, 0, 4, 2 }, 0, false }, { { 0, 0, 3, 3 }, 0, false }, { { 0, 0, 2, 5 }, 0, false } };
+	std::vector<BinRect> rects { { { 0, 0, 4, 2 }, 0, false }, { { 4, 0, 3, 3 }, 0, false }, { { 0, 3, 5, 2 }, 0, true } };
+
+	CHECK(validatePacking({ false, 1, 0 }, 10, 10, rects));
+	CHECK(validatePackingAgainst({ false, 1, 0 }, 10, 10, rects, originals));
+
+	SECTION("Overlap") {
+		rects[2].rect.x = 3;
+		rects[2].rect.y = 1;
+
+		const auto result = validatePacking({ false, 1, 0 }, 10, 10, rects);
+		CHECK(result.error == ValidationError::Overlap);
+		CHECK(result.index != result.other);
+	}
+
+	SECTION("Touching") {
+		// Lies right below the second rectangle, which lies right next to the first one
+		rects[2].rect.x = 4;
+
+		CHECK(validatePacking({ false, 1, 0 }, 10, 10, rects));
+	}
+
+	SECTION("Different Bins") {
+		rects[2] = { { 0, 0, 2, 5 }, 1, false };
+		CHECK(validatePacking({ false, 2, 0 }, 10, 10, rects));
+		CHECK(validatePacking({ false, 1, 0 }, 10, 10, rects).error == ValidationError::BinOutOfRange);
+	}
+
+	SECTION("Out Of Bounds") {
+		rects[1].rect.x = 8;
+		CHECK(validatePacking({ false, 1, 0 }, 10, 10, rects).error == ValidationError::OutOfBounds);
+	}
+
+	SECTION("Not Packed") {
+		rects[1].bin = InvalidBin;
+		CHECK(validatePacking({ false, 1, 0 }, 10, 10, rects).error == ValidationError::NotPacked);
+		CHECK(validatePacking({ true, 1, 0 }, 10, 10, rects));
+	}
+
+	SECTION("Size Mismatch") {
+		rects[2].flipped = false;
+
+		const auto result = validatePackingAgainst({ false, 1, 0 }, 10, 10, rects, originals);
+		CHECK(result.error == ValidationError::SizeMismatch);
+		CHECK(result.index == 2);
+	}
+}
+
+TEST_CASE("Validate Random Overlaps", "[Validate]") {
+	std::mt19937 generator(42);
+	std::uniform_int_distribution<unsigned int> position(0, 20), size(1, 6);
+
+	for (auto i = 0; i < 200; ++i) {
+		std::vector<BinRect> rects;
+
+		for (auto j = 0; j < 10; ++j)
+			rects.push_back({ { position(generator), position(generator), size(generator), size(generator) }, (unsigned int) j % 2, false });
+
+		auto overlaps = false;
+
+		for (auto a = 0u; a < rects.size(); ++a)
+			for (auto b = a + 1; b < rects.size(); ++b)
+				overlaps |= rects[a].bin == rects[b].bin && rects[a].rect.intersect(rects[b].rect);
+
+		const auto result = validatePacking({ false, 2, 0 }, 30, 30, rects);
+		CHECK((result.error == ValidationError::Overlap) == overlaps);
+	}
+}
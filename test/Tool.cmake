@@ -0,0 +1,72 @@
+# Runs the rectbinpack tool with TOOL and checks its arguments, exit codes and output
+# Usage: cmake -DTOOL=<path to rectbinpack> -DWORK_DIR=<scratch directory> -P Tool.cmake
+
+function(run_tool expected_result)
+	execute_process(
+		COMMAND "${TOOL}" ${ARGN}
+		RESULT_VARIABLE result
+		OUTPUT_VARIABLE output
+		ERROR_VARIABLE error
+	)
+
+	if(NOT "${result}" STREQUAL "${expected_result}")
+		message(FATAL_ERROR "rectbinpack ${ARGN} returned ${result} instead of ${expected_result}\n${output}${error}")
+	endif()
+
+	set(output "${output}" PARENT_SCOPE)
+	set(error "${error}" PARENT_SCOPE)
+endfunction()
+
+function(expect_match text pattern)
+	if(NOT "${text}" MATCHES "${pattern}")
+		message(FATAL_ERROR "expected output matching ${pattern}, got:\n${text}")
+	endif()
+endfunction()
+
+# Help is printed to stdout and isn't an error
+run_tool(0 --help)
+expect_match("${output}" "^Usage: rectbinpack")
+
+# Invalid arguments
+run_tool(2 --width -1 "${WORK_DIR}/missing.csv")
+expect_match("${error}" "invalid number for --width: -1")
+run_tool(2 --height +5 "${WORK_DIR}/missing.csv")
+run_tool(2 --min-bins 99999999999 "${WORK_DIR}/missing.csv")
+run_tool(2 --obstacle 1,2,-3,4 "${WORK_DIR}/missing.csv")
+run_tool(2 --engine exact --heuristic best-area-fit "${WORK_DIR}/missing.csv")
+expect_match("${error}" "--heuristic isn't supported by the exact engine")
+run_tool(2 --unknown)
+run_tool(2 a.csv b.csv)
+
+# Negative sizes in the input are rejected
+file(WRITE "${WORK_DIR}/negative.csv" "-1,4\n")
+run_tool(2 "${WORK_DIR}/negative.csv")
+expect_match("${error}" "invalid rectangle in line 1")
+
+# Names with commas and quotes survive the round trip from CSV to JSON and from JSON to CSV
+file(WRITE "${WORK_DIR}/names.csv" "plain,4,4\n\"a,b\",2,3\n\"say \"\"hi\"\"\",5,1\n")
+run_tool(0 -w 16 -h 16 -f json "${WORK_DIR}/names.csv")
+expect_match("${output}" "\"name\":\"plain\",[^\n]*\"width\":4,\"height\":4,\"bin\":0")
+expect_match("${output}" "\"name\":\"a,b\",[^\n]*\"width\":2,\"height\":3,\"bin\":0")
+expect_match("${output}" "\"name\":\"say \\\\\"hi\\\\\"\",[^\n]*\"width\":5,\"height\":1,\"bin\":0")
+expect_match("${error}" "3 of 3 rectangles packed into 1 bins")
+
+file(WRITE "${WORK_DIR}/names.json" "${output}")
+run_tool(0 -w 16 -h 16 -o "${WORK_DIR}/names.out.csv" "${WORK_DIR}/names.json")
+file(READ "${WORK_DIR}/names.out.csv" output)
+expect_match("${output}" "^name,x,y,width,height,bin,flipped\nplain,[0-9]+,[0-9]+,4,4,0,0\n")
+expect_match("${output}" "\n\"a,b\",[0-9]+,[0-9]+,2,3,0,0\n")
+expect_match("${output}" "\n\"say \"\"hi\"\"\",[0-9]+,[0-9]+,5,1,0,0\n")
+
+# Only the rectangles which were placed are counted
+file(WRITE "${WORK_DIR}/partial.csv" "5,5\n5,5\n")
+run_tool(1 -w 8 -h 8 --max-bins 1 "${WORK_DIR}/partial.csv")
+expect_match("${output}" ",5,5,-1,0\n")
+expect_match("${error}" "1 of 2 rectangles packed into 1 bins")
+
+# Escapes in JSON strings are decoded and nested values of unknown keys are skipped
+file(WRITE "${WORK_DIR}/escapes.json" "{\"name\":\"a\\nb\\u0041\\t\\/\\\\\",\"width\":2,\"height\":2}\n")
+file(APPEND "${WORK_DIR}/escapes.json" "{\"width\":2,\"height\":2,\"tags\":[1,{\"a\":[2,\"]}\"]}],\"name\":\"nested\"}\n")
+run_tool(0 -w 8 -h 8 -f json "${WORK_DIR}/escapes.json")
+expect_match("${output}" "\"name\":\"a\\\\u000abA\\\\u0009/\\\\\\\\\",[^\n]*\"width\":2,\"height\":2,\"bin\":0")
+expect_match("${output}" "\"name\":\"nested\",[^\n]*\"width\":2,\"height\":2,\"bin\":0")